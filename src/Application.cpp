@@ -3,6 +3,7 @@
 #include "layers/EditorLayer.hpp"
 #include "OpenGL.hpp"
 #include "TriggerClock.hpp"
+#include "JobSystem.hpp"
 #include "TextureManager.hpp"
 #include "renderer/Renderer.hpp"
 
@@ -25,6 +26,8 @@ Application::Application(const WindowSpec& spec)
 
 	LOG_INFO("Logger initialized");
 
+	JobSystem::Init();
+
 	if (glfwInit() == GLFW_FALSE)
 	{
 		LOG_CRITICAL("Failed to initialize GLFW!");
@@ -83,6 +86,12 @@ Application::Application(const WindowSpec& spec)
 
 Application::~Application()
 {
+	// Layers wait on their jobs (autosaves, exports, seeks) and free GL objects, both need the window and the workers alive
+	while (!m_Layers.empty())
+	{
+		m_Layers.pop();
+	}
+
 	if (m_Window)
 	{
 		glfwDestroyWindow(m_Window);
@@ -90,6 +99,7 @@ Application::~Application()
 	
 	glfwTerminate();
 	Renderer::Shutdown();
+	JobSystem::Shutdown();
 }
 
 void Application::Run()
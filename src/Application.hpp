@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Event.hpp"
+#include "physics/SimClock.hpp"
 
 #include <string>
 #include <memory>
@@ -33,9 +34,8 @@ public:
 
 	inline static Application* GetInstance() { return s_Instance; }
 	
-	inline static constexpr uint32_t TPS = 240;
-	inline static constexpr float TPS_STEP = 1.0f / TPS;
-	inline static float TPS_MULTIPLIER = 1.0f;
+	inline static constexpr uint32_t TPS = SimClock::TPS;
+	inline static constexpr float TPS_STEP = SimClock::TPS_STEP;
 
 private:
 	void SetWindowCallbacks();
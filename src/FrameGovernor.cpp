@@ -0,0 +1,88 @@
+#include "FrameGovernor.hpp"
+#include "physics/SimClock.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+// Weight of the newest sample in the running averages, keeps a single hitch from flipping the plan
+static constexpr float SMOOTHING = 0.1f;
+
+// How often the achieved warp gets refreshed [seconds]
+static constexpr float WARP_WINDOW = 0.5f;
+
+FrameGovernor::StepPlan FrameGovernor::Plan(float targetTimeScale) const
+{
+	if (!Enabled || targetTimeScale <= 0.0f || MaxStepTimeScale <= 0.0f)
+	{
+		return { 1, targetTimeScale };
+	}
+
+	// Substeps needed to reach the requested time scale without exceeding the step bound
+	uint32_t needed = (uint32_t)std::ceil(targetTimeScale / MaxStepTimeScale);
+	needed = std::clamp(needed, 1u, MAX_SUBSTEPS);
+
+	// Deterministic runs can't let the frame time pick the step size, they fall behind real time instead
+	if (needed <= m_AllowedSubsteps || SimClock::DETERMINISTIC)
+	{
+		return { needed, targetTimeScale / needed };
+	}
+
+	// Can't afford the full time scale, so run as much as the budget allows at the biggest step
+	return { m_AllowedSubsteps, MaxStepTimeScale };
+}
+
+void FrameGovernor::OnTickFinished(float costMs, uint32_t substeps, float simulatedTime)
+{
+	float perStep = costMs / std::max(substeps, 1u);
+
+	m_StepCostMs = m_StepCostMs == 0.0f ? perStep : std::lerp(m_StepCostMs, perStep, SMOOTHING);
+	m_PhysicsMsThisFrame += costMs;
+	m_TicksThisFrame++;
+	m_SimulatedTimeWindow += simulatedTime;
+}
+
+void FrameGovernor::OnFrame(float ts)
+{
+	float frameMs = ts * 1000.0f;
+	float nonPhysicsMs = std::max(frameMs - m_PhysicsMsThisFrame, 0.0f);
+
+	m_NonPhysicsMs  = std::lerp(m_NonPhysicsMs, nonPhysicsMs, SMOOTHING);
+	m_TicksPerFrame = std::lerp(m_TicksPerFrame, (float)m_TicksThisFrame, SMOOTHING);
+
+	m_PhysicsMsThisFrame = 0.0f;
+	m_TicksThisFrame = 0;
+
+	if (m_StepCostMs > 0.0f)
+	{
+		// A frame holding a tick at all has to absorb its full cost, hence at least one tick per frame
+		float available = FrameBudgetMs - m_NonPhysicsMs;
+		float perTickCost = std::max(m_TicksPerFrame, 1.0f) * m_StepCostMs;
+		float affordable = std::floor(available / perTickCost);
+
+		m_AllowedSubsteps = (uint32_t)std::clamp(affordable, 1.0f, (float)MAX_SUBSTEPS);
+	}
+
+	m_RealTimeWindow += ts;
+
+	if (m_RealTimeWindow >= WARP_WINDOW)
+	{
+		m_AchievedWarp = m_SimulatedTimeWindow / m_RealTimeWindow;
+		m_SimulatedTimeWindow = 0.0f;
+		m_RealTimeWindow = 0.0f;
+	}
+}
+
+void FrameGovernor::Reset()
+{
+	m_StepCostMs	  = 0.0f;
+	m_NonPhysicsMs	  = 0.0f;
+	m_TicksPerFrame	  = 1.0f;
+	m_AllowedSubsteps = 1;
+
+	m_PhysicsMsThisFrame = 0.0f;
+	m_TicksThisFrame	 = 0;
+
+	m_SimulatedTimeWindow = 0.0f;
+	m_RealTimeWindow	  = 0.0f;
+	m_AchievedWarp		  = 0.0f;
+}
\ No newline at end of file
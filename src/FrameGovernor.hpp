@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+
+// Decides how many physics substeps a tick runs and how big each of them is,
+// so the simulation covers as much time as possible without pushing the frame over budget.
+class FrameGovernor
+{
+public:
+	struct StepPlan
+	{
+		uint32_t Substeps = 1;
+		float TimeScale = 1.0f;
+	};
+
+	StepPlan Plan(float targetTimeScale) const;
+
+	void OnTickFinished(float costMs, uint32_t substeps, float simulatedTime);
+	void OnFrame(float ts);
+	void Reset();
+
+	inline float GetAchievedWarp()   const { return m_AchievedWarp;   }
+	inline float GetStepCostMs()	 const { return m_StepCostMs;	  }
+	inline uint32_t GetMaxSubsteps() const { return m_AllowedSubsteps; }
+
+	bool Enabled = true;
+
+	// Frame time the physics must fit into, together with everything else drawn that frame
+	float FrameBudgetMs = 16.0f;
+
+	// Biggest time scale a single substep may use, bounds the integration error
+	float MaxStepTimeScale = 5.0f;
+
+	inline static constexpr uint32_t MAX_SUBSTEPS = 64;
+
+private:
+	float m_StepCostMs		 = 0.0f;
+	float m_NonPhysicsMs	 = 0.0f;
+	float m_TicksPerFrame	 = 1.0f;
+	uint32_t m_AllowedSubsteps = 1;
+
+	float m_PhysicsMsThisFrame = 0.0f;
+	uint32_t m_TicksThisFrame  = 0;
+
+	float m_SimulatedTimeWindow = 0.0f;
+	float m_RealTimeWindow		= 0.0f;
+	float m_AchievedWarp		= 0.0f;
+};
\ No newline at end of file
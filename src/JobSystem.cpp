@@ -0,0 +1,375 @@
+#include "JobSystem.hpp"
+#include "Logger.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+struct Job;
+
+struct JobState
+{
+	std::atomic<bool> Finished = false;
+
+	std::mutex Mutex;
+	std::condition_variable FinishedCV;
+	std::vector<std::shared_ptr<Job>> Dependents;
+
+	// Lets Wait run the job itself instead of sleeping while it still sits in a queue
+	std::weak_ptr<Job> Pending;
+};
+
+struct Job
+{
+	std::function<void(void)> Func;
+	JobHandle State;
+	std::vector<JobHandle> Dependencies;
+
+	// Whoever flips it first runs the job, the other copy is skipped
+	std::atomic<bool> Claimed = false;
+
+	// Starts at 1 so the job can't get queued while Submit is still registering dependencies
+	std::atomic<uint32_t> UnfinishedDependencies = 1;
+};
+
+struct WorkerQueue
+{
+	std::mutex Mutex;
+	std::deque<std::shared_ptr<Job>> Jobs;
+};
+
+struct JobSystemData
+{
+	std::vector<std::thread> Workers;
+	std::vector<std::unique_ptr<WorkerQueue>> Queues;
+
+	std::atomic<int32_t>  QueuedJobs = 0;
+	std::atomic<uint32_t> NextQueue  = 0;
+	std::atomic<bool>	  Running	 = false;
+
+	std::mutex SleepMutex;
+	std::condition_variable SleepCV;
+};
+
+static JobSystemData s_Data;
+static thread_local int32_t s_WorkerIdx = -1;
+
+static void Enqueue(std::shared_ptr<Job>&& job)
+{
+	uint32_t queueIdx = s_WorkerIdx >= 0 ? (uint32_t)s_WorkerIdx : s_Data.NextQueue++ % (uint32_t)s_Data.Queues.size();
+	WorkerQueue& queue = *s_Data.Queues[queueIdx];
+
+	{
+		std::lock_guard<std::mutex> lg(queue.Mutex);
+		queue.Jobs.push_back(std::move(job));
+	}
+
+	s_Data.QueuedJobs++;
+
+	{
+		std::lock_guard<std::mutex> lg(s_Data.SleepMutex);
+	}
+
+	s_Data.SleepCV.notify_one();
+}
+
+static std::shared_ptr<Job> PopJob()
+{
+	std::shared_ptr<Job> job;
+	uint32_t queueCount = (uint32_t)s_Data.Queues.size();
+
+	// Own queue is LIFO for cache warmth, others get robbed from the opposite end
+	if (s_WorkerIdx >= 0)
+	{
+		WorkerQueue& own = *s_Data.Queues[s_WorkerIdx];
+		std::lock_guard<std::mutex> lg(own.Mutex);
+
+		if (!own.Jobs.empty())
+		{
+			job = std::move(own.Jobs.back());
+			own.Jobs.pop_back();
+			s_Data.QueuedJobs--;
+
+			return job;
+		}
+	}
+
+	uint32_t start = s_WorkerIdx >= 0 ? (uint32_t)s_WorkerIdx + 1 : 0;
+
+	for (uint32_t i = 0; i < queueCount; i++)
+	{
+		WorkerQueue& victim = *s_Data.Queues[(start + i) % queueCount];
+		std::lock_guard<std::mutex> lg(victim.Mutex);
+
+		if (!victim.Jobs.empty())
+		{
+			job = std::move(victim.Jobs.front());
+			victim.Jobs.pop_front();
+			s_Data.QueuedJobs--;
+
+			return job;
+		}
+	}
+
+	return job;
+}
+
+static void FinishJob(JobState& state)
+{
+	std::vector<std::shared_ptr<Job>> dependents;
+
+	{
+		std::lock_guard<std::mutex> lg(state.Mutex);
+		state.Finished = true;
+		dependents.swap(state.Dependents);
+	}
+
+	state.FinishedCV.notify_all();
+
+	for (std::shared_ptr<Job>& dependent : dependents)
+	{
+		if (--dependent->UnfinishedDependencies == 0)
+		{
+			Enqueue(std::move(dependent));
+		}
+	}
+}
+
+void JobSystem::Init(uint32_t workerCount)
+{
+	if (s_Data.Running)
+	{
+		Shutdown();
+	}
+
+	if (workerCount == 0)
+	{
+		// Main thread runs its own share of ParallelFor chunks, so leave a core for it
+		workerCount = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+	}
+
+	s_Data.Queues.clear();
+
+	for (uint32_t i = 0; i < workerCount; i++)
+	{
+		s_Data.Queues.push_back(std::make_unique<WorkerQueue>());
+	}
+
+	s_Data.QueuedJobs = 0;
+	s_Data.Running = true;
+
+	for (uint32_t i = 0; i < workerCount; i++)
+	{
+		s_Data.Workers.emplace_back(&JobSystem::WorkerLoop, i);
+	}
+
+	LOG_INFO("Job system started with {} workers", workerCount);
+}
+
+void JobSystem::Shutdown()
+{
+	if (!s_Data.Running)
+	{
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lg(s_Data.SleepMutex);
+		s_Data.Running = false;
+	}
+
+	s_Data.SleepCV.notify_all();
+
+	for (std::thread& worker : s_Data.Workers)
+	{
+		worker.join();
+	}
+
+	s_Data.Workers.clear();
+
+	// Dropping queued jobs would leave their handles unfinished forever, so the rest runs here
+	while (RunOneJob());
+
+	s_Data.Queues.clear();
+}
+
+JobHandle JobSystem::Submit(std::function<void(void)> job, const std::vector<JobHandle>& dependencies)
+{
+	JobHandle state = std::make_shared<JobState>();
+
+	// No workers, everything submitted before already ran inline so the dependencies are met
+	if (!s_Data.Running)
+	{
+		job();
+		state->Finished = true;
+
+		return state;
+	}
+
+	auto newJob = std::make_shared<Job>();
+	newJob->Func = std::move(job);
+	newJob->State = state;
+	newJob->Dependencies = dependencies;
+	state->Pending = newJob;
+
+	for (const JobHandle& dependency : dependencies)
+	{
+		if (!dependency)
+		{
+			continue;
+		}
+
+		std::lock_guard<std::mutex> lg(dependency->Mutex);
+
+		if (!dependency->Finished)
+		{
+			newJob->UnfinishedDependencies++;
+			dependency->Dependents.push_back(newJob);
+		}
+	}
+
+	if (--newJob->UnfinishedDependencies == 0)
+	{
+		Enqueue(std::move(newJob));
+	}
+
+	return state;
+}
+
+void JobSystem::Wait(const JobHandle& handle)
+{
+	if (!handle)
+	{
+		return;
+	}
+
+	std::shared_ptr<Job> job = handle->Pending.lock();
+
+	if (job && !handle->Finished)
+	{
+		for (const JobHandle& dependency : job->Dependencies)
+		{
+			Wait(dependency);
+		}
+
+		if (!job->Claimed.exchange(true))
+		{
+			job->Func();
+			FinishJob(*handle);
+
+			return;
+		}
+	}
+
+	// Someone else runs it already
+	std::unique_lock<std::mutex> lock(handle->Mutex);
+	handle->FinishedCV.wait(lock, [&]() { return handle->Finished.load(); });
+}
+
+bool JobSystem::IsDone(const JobHandle& handle)
+{
+	return !handle || handle->Finished;
+}
+
+void JobSystem::ParallelFor(uint32_t begin, uint32_t end, uint32_t grainSize, const std::function<void(uint32_t, uint32_t)>& func)
+{
+	if (begin >= end)
+	{
+		return;
+	}
+
+	grainSize = std::max(grainSize, 1u);
+	uint32_t chunkCount = (end - begin + grainSize - 1) / grainSize;
+
+	if (chunkCount == 1 || s_Data.Workers.empty())
+	{
+		for (uint32_t chunkBegin = begin; chunkBegin < end; chunkBegin += grainSize)
+		{
+			func(chunkBegin, std::min(chunkBegin + grainSize, end));
+		}
+
+		return;
+	}
+
+	std::atomic<uint32_t> nextChunk = 0;
+
+	auto runChunks = [&]()
+		{
+			for (uint32_t chunk = nextChunk++; chunk < chunkCount; chunk = nextChunk++)
+			{
+				uint32_t chunkBegin = begin + chunk * grainSize;
+
+				func(chunkBegin, std::min(chunkBegin + grainSize, end));
+			}
+		};
+
+	uint32_t helperCount = std::min(chunkCount - 1, (uint32_t)s_Data.Workers.size());
+	std::vector<JobHandle> helpers;
+	helpers.reserve(helperCount);
+
+	for (uint32_t i = 0; i < helperCount; i++)
+	{
+		helpers.push_back(Submit(runChunks));
+	}
+
+	runChunks();
+
+	// Helpers reference this stack frame, all of them have to be done before returning.
+	// Ones that didn't start yet run here and find no chunks left, so no foreign job ever gets picked up.
+	for (const JobHandle& helper : helpers)
+	{
+		Wait(helper);
+	}
+}
+
+uint32_t JobSystem::GetWorkerCount()
+{
+	return (uint32_t)s_Data.Workers.size();
+}
+
+void JobSystem::WorkerLoop(uint32_t workerIdx)
+{
+	s_WorkerIdx = (int32_t)workerIdx;
+
+	while (s_Data.Running)
+	{
+		if (RunOneJob())
+		{
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(s_Data.SleepMutex);
+		s_Data.SleepCV.wait(lock, []() { return s_Data.QueuedJobs > 0 || !s_Data.Running; });
+	}
+
+	s_WorkerIdx = -1;
+}
+
+bool JobSystem::RunOneJob()
+{
+	if (s_Data.Queues.empty())
+	{
+		return false;
+	}
+
+	std::shared_ptr<Job> job = PopJob();
+
+	if (!job)
+	{
+		return false;
+	}
+
+	// Its waiter ran it already
+	if (job->Claimed.exchange(true))
+	{
+		return true;
+	}
+
+	job->Func();
+	FinishJob(*job->State);
+
+	return true;
+}
\ No newline at end of file
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <vector>
+#include <cstdint>
+
+struct JobState;
+
+// Waitable handle of a submitted job, empty handle counts as already finished
+using JobHandle = std::shared_ptr<JobState>;
+
+class JobSystem
+{
+public:
+	static void Init(uint32_t workerCount = 0);
+	static void Shutdown();
+
+	// Job starts only after every dependency finished
+	static JobHandle Submit(std::function<void(void)> job, const std::vector<JobHandle>& dependencies = {});
+
+	// Runs the job (and its unstarted dependencies) on the calling thread if nobody picked it up yet,
+	// otherwise sleeps until it finishes. Never runs unrelated jobs, so it's safe on tick or render thread
+	static void Wait(const JobHandle& handle);
+	static bool IsDone(const JobHandle& handle);
+
+	// Splits [begin, end) into chunks of grainSize and runs func(chunkBegin, chunkEnd) on them.
+	// Chunk boundaries only depend on grainSize, never on the worker count.
+	static void ParallelFor(uint32_t begin, uint32_t end, uint32_t grainSize, const std::function<void(uint32_t, uint32_t)>& func);
+
+	static uint32_t GetWorkerCount();
+
+private:
+	JobSystem() = default;
+
+	static void WorkerLoop(uint32_t workerIdx);
+	static bool RunOneJob();
+};
\ No newline at end of file
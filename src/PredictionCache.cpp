@@ -0,0 +1,288 @@
+#include "PredictionCache.hpp"
+#include "Simulator.hpp"
+#include "scenes/PlanetBodies.hpp"
+#include "physics/SimClock.hpp"
+
+#include <algorithm>
+
+static constexpr double SAMPLE_DURATION = (double)SimClock::TPS_STEP * SimPhysics::PREDICTION_TIME_SCALE * PredictionCache::STEPS_PER_SAMPLE;
+
+PredictionCache::~PredictionCache()
+{
+	++m_Generation;
+	JobSystem::Wait(m_Job);
+}
+
+void PredictionCache::Sync(const std::vector<std::unique_ptr<Planet>>& planets, double time)
+{
+	static thread_local BodyStore s_Snapshot;
+	static thread_local std::vector<int32_t> s_References;
+
+	PlanetBodies::TakeSnapshot(planets, s_Snapshot);
+	s_References.resize(planets.size());
+
+	for (size_t i = 0; i < planets.size(); i++)
+	{
+		Planet* reference = planets[i]->GetRelativePlanet();
+		auto referenceIt = std::find_if(planets.begin(), planets.end(),
+			[reference](const std::unique_ptr<Planet>& planet) { return planet.get() == reference; });
+
+		s_References[i] = reference && referenceIt != planets.end() ? (int32_t)(referenceIt - planets.begin()) : -1;
+	}
+
+	float gMultiplier = SimPhysics::G_CONSTANT_MULTIPLIER;
+	bool edited = s_Snapshot.Size() != m_Paths.size() || s_Snapshot.Masses != m_Masses || gMultiplier != m_GMultiplier || time < m_StartTime;
+
+	// A running simulation moves the bodies away from the first sample every tick, that's no edit.
+	// Only a scene standing at the paths' start time can be compared against them.
+	for (size_t i = 0; !edited && time == m_StartTime && i < s_Snapshot.Size(); i++)
+	{
+		edited = s_Snapshot.Positions[i] != m_Paths[i][0] || s_Snapshot.Velocities[i] != m_Velocities[i][0];
+	}
+
+	if (!edited)
+	{
+		bool referencesChanged = s_References != m_References;
+		m_References = s_References;
+
+		if (time > m_StartTime)
+		{
+			Advance(time);
+		}
+
+		if (referencesChanged)
+		{
+			UpdateRelativePaths(0);
+		}
+
+		Extend();
+
+		return;
+	}
+
+	m_StartTime = time;
+	m_Masses = s_Snapshot.Masses;
+	m_GMultiplier = gMultiplier;
+	m_References = s_References;
+	m_Paths.resize(s_Snapshot.Size());
+	m_Velocities.resize(s_Snapshot.Size());
+	m_RelativePaths.resize(s_Snapshot.Size());
+
+	for (size_t i = 0; i < s_Snapshot.Size(); i++)
+	{
+		m_Paths[i].assign(1, s_Snapshot.Positions[i]);
+		m_Velocities[i].assign(1, s_Snapshot.Velocities[i]);
+	}
+
+	UpdateRelativePaths(0);
+
+	// Edited state is the very start of every path now, nothing past it can be reused
+	Invalidate(0);
+}
+
+void PredictionCache::Invalidate(uint32_t fromSample)
+{
+	uint64_t generation = ++m_Generation;
+
+	{
+		std::lock_guard<std::mutex> lg(m_IncomingMutex);
+		m_Incoming.clear();
+	}
+
+	if (m_Paths.empty())
+	{
+		return;
+	}
+
+	fromSample = std::min(fromSample, GetSampleCount() - 1);
+
+	for (size_t i = 0; i < m_Paths.size(); i++)
+	{
+		m_Paths[i].resize(fromSample + 1);
+		m_Velocities[i].resize(fromSample + 1);
+		m_RelativePaths[i].resize(fromSample + 1);
+	}
+
+	StartBuild(fromSample, generation);
+}
+
+void PredictionCache::Advance(double time)
+{
+	if (m_Paths.empty())
+	{
+		return;
+	}
+
+	uint32_t passed = (uint32_t)std::min((time - m_StartTime) / SAMPLE_DURATION, (double)GetSampleCount() - 1.0);
+
+	if (passed == 0)
+	{
+		return;
+	}
+
+	// Samples of a build still running keep getting appended at the back, dropping from the front doesn't disturb it
+	for (size_t i = 0; i < m_Paths.size(); i++)
+	{
+		m_Paths[i].erase(m_Paths[i].begin(), m_Paths[i].begin() + passed);
+		m_Velocities[i].erase(m_Velocities[i].begin(), m_Velocities[i].begin() + passed);
+	}
+
+	m_StartTime += passed * SAMPLE_DURATION;
+	UpdateRelativePaths(0);
+}
+
+void PredictionCache::Extend()
+{
+	if (m_Paths.empty() || GetSampleCount() >= SAMPLE_COUNT || !JobSystem::IsDone(m_Job))
+	{
+		return;
+	}
+
+	{
+		// Finished build's last samples weren't polled yet
+		std::lock_guard<std::mutex> lg(m_IncomingMutex);
+
+		if (!m_Incoming.empty())
+		{
+			return;
+		}
+	}
+
+	// Same generation, the samples continue the current paths
+	StartBuild(GetSampleCount() - 1, m_Generation.load());
+}
+
+void PredictionCache::StartBuild(uint32_t fromSample, uint64_t generation)
+{
+	BodyStore bodies;
+	bodies.Resize(m_Paths.size());
+	bodies.Masses = m_Masses;
+
+	for (size_t i = 0; i < m_Paths.size(); i++)
+	{
+		bodies.Positions[i]  = m_Paths[i][fromSample];
+		bodies.Velocities[i] = m_Velocities[i][fromSample];
+	}
+
+	uint32_t sampleCount = SAMPLE_COUNT - (fromSample + 1);
+
+	// Chained onto the previous build, which bails out on the generation change, so waiting on m_Job covers every build
+	m_Job = JobSystem::Submit([this, bodies = std::move(bodies), gMultiplier = m_GMultiplier, sampleCount, generation]() mutable
+		{
+			Integrate(std::move(bodies), gMultiplier, sampleCount, generation);
+		}, { m_Job });
+}
+
+bool PredictionCache::Poll()
+{
+	std::vector<SampleChunk> incoming;
+
+	{
+		std::lock_guard<std::mutex> lg(m_IncomingMutex);
+		incoming.swap(m_Incoming);
+	}
+
+	bool changed = false;
+	size_t bodyCount = m_Paths.size();
+	uint32_t firstNewSample = GetSampleCount();
+
+	for (const SampleChunk& chunk : incoming)
+	{
+		if (chunk.Generation != m_Generation.load() || bodyCount == 0)
+		{
+			continue;
+		}
+
+		for (size_t sample = 0; sample < chunk.Positions.size() / bodyCount; sample++)
+		{
+			for (size_t i = 0; i < bodyCount; i++)
+			{
+				m_Paths[i].push_back(chunk.Positions[sample * bodyCount + i]);
+				m_Velocities[i].push_back(chunk.Velocities[sample * bodyCount + i]);
+			}
+		}
+
+		changed = true;
+	}
+
+	if (changed)
+	{
+		UpdateRelativePaths(firstNewSample);
+	}
+
+	return changed;
+}
+
+void PredictionCache::Integrate(BodyStore bodies, float gMultiplier, uint32_t sampleCount, uint64_t generation)
+{
+	size_t bodyCount = bodies.Size();
+	SampleChunk chunk;
+	chunk.Generation = generation;
+
+	for (uint32_t sample = 0; sample < sampleCount; sample++)
+	{
+		if (m_Generation.load() != generation)
+		{
+			return;
+		}
+
+		for (uint32_t step = 0; step < STEPS_PER_SAMPLE; step++)
+		{
+			SimPhysics::StepBodies(bodies, SimPhysics::PREDICTION_TIME_SCALE, gMultiplier);
+		}
+
+		chunk.Positions.insert(chunk.Positions.end(), bodies.Positions.begin(), bodies.Positions.end());
+		chunk.Velocities.insert(chunk.Velocities.end(), bodies.Velocities.begin(), bodies.Velocities.end());
+
+		if (chunk.Positions.size() == SAMPLES_PER_CHUNK * bodyCount)
+		{
+			Publish(std::move(chunk));
+
+			chunk = SampleChunk{};
+			chunk.Generation = generation;
+		}
+	}
+
+	if (!chunk.Positions.empty())
+	{
+		Publish(std::move(chunk));
+	}
+}
+
+void PredictionCache::Publish(SampleChunk&& chunk)
+{
+	std::lock_guard<std::mutex> lg(m_IncomingMutex);
+	m_Incoming.push_back(std::move(chunk));
+}
+
+void PredictionCache::UpdateRelativePaths(uint32_t fromSample)
+{
+	uint32_t sampleCount = GetSampleCount();
+
+	if (fromSample >= sampleCount)
+	{
+		return;
+	}
+
+	// Plain float arrays subtracted element by element, so the compiler is free to vectorize the whole pass
+	uint32_t floatCount = (sampleCount - fromSample) * 3;
+
+	for (size_t i = 0; i < m_Paths.size(); i++)
+	{
+		if (m_References[i] < 0)
+		{
+			continue;
+		}
+
+		m_RelativePaths[i].resize(sampleCount);
+
+		const float* body = &m_Paths[i][fromSample].x;
+		const float* reference = &m_Paths[m_References[i]][fromSample].x;
+		float* relative = &m_RelativePaths[i][fromSample].x;
+
+		for (uint32_t j = 0; j < floatCount; j++)
+		{
+			relative[j] = body[j] - reference[j];
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "JobSystem.hpp"
+#include "physics/BodyStore.hpp"
+
+#include <glm/glm.hpp>
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+class Planet;
+
+// Future paths of every body in the scene, coming from a single integration of the whole system.
+// Samples are integrated in the background and only ever thrown away past the point where the scene got edited.
+// Every path is also kept relative to the body's reference planet, so moons can be drawn circling their planets.
+class PredictionCache
+{
+public:
+	PredictionCache() = default;
+	~PredictionCache();
+
+	// Compares the scene with the state the cached paths start from and invalidates them when it changed.
+	// Only masses, positions, velocities and the G multiplier matter, any other edit keeps the cache intact.
+	// G is read here on the calling thread, workers only get the copy taken with the paths' start state.
+	// Changing a reference planet only redoes the relative paths, nothing gets integrated again.
+	// Time is the simulated time of the scene in days. Once it moves on, samples it passed get dropped and
+	// the paths are topped up at the far end, so a running simulation never rebuilds the cache on its own.
+	// An edit restarts the paths at the time it happened, everything before it is history anyway.
+	void Sync(const std::vector<std::unique_ptr<Planet>>& planets, double time);
+
+	// Drops everything after fromSample and integrates again from the state stored there
+	void Invalidate(uint32_t fromSample = 0);
+
+	// Appends samples integrated since the last call, returns true when any path changed
+	bool Poll();
+
+	inline size_t GetBodyCount() const { return m_Paths.size(); }
+	inline uint32_t GetSampleCount() const { return m_Paths.empty() ? 0 : (uint32_t)m_Paths[0].size(); }
+	inline const std::vector<glm::vec3>& GetPath(size_t bodyIdx) const { return m_Paths[bodyIdx]; }
+
+	// Path as seen from the reference body, same as GetPath for bodies without one
+	inline const std::vector<glm::vec3>& GetRelativePath(size_t bodyIdx) const
+	{
+		return m_References[bodyIdx] < 0 ? m_Paths[bodyIdx] : m_RelativePaths[bodyIdx];
+	}
+
+	// Index of the body the relative path is measured from, -1 when there's none
+	inline int32_t GetReferenceBody(size_t bodyIdx) const { return m_References[bodyIdx]; }
+
+	inline static constexpr uint32_t SAMPLE_COUNT	   = 5120;
+	inline static constexpr uint32_t STEPS_PER_SAMPLE  = 2;
+	inline static constexpr uint32_t SAMPLES_PER_CHUNK = 64;
+
+private:
+	// Sample-major block of positions and velocities, [sample * bodyCount + body]
+	struct SampleChunk
+	{
+		std::vector<glm::vec3> Positions;
+		std::vector<glm::vec3> Velocities;
+		uint64_t Generation = 0;
+	};
+
+	void Advance(double time);
+	void Extend();
+	void StartBuild(uint32_t fromSample, uint64_t generation);
+	void Integrate(BodyStore bodies, float gMultiplier, uint32_t sampleCount, uint64_t generation);
+	void Publish(SampleChunk&& chunk);
+	void UpdateRelativePaths(uint32_t fromSample);
+
+	// Both indexed [body][sample], velocities are kept so integration can resume from any sample
+	std::vector<std::vector<glm::vec3>> m_Paths;
+	std::vector<std::vector<glm::vec3>> m_Velocities;
+	std::vector<std::vector<glm::vec3>> m_RelativePaths;
+	std::vector<int32_t> m_References;
+	std::vector<float> m_Masses;
+	float m_GMultiplier = 1.0f;
+
+	// Simulated time of the first sample, in days
+	double m_StartTime = 0.0;
+
+	std::mutex m_IncomingMutex;
+	std::vector<SampleChunk> m_Incoming;
+
+	std::atomic<uint64_t> m_Generation = 0;
+
+	JobHandle m_Job;
+};
\ No newline at end of file
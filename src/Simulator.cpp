@@ -1,154 +1,357 @@
 #include "Simulator.hpp"
 #include "Logger.hpp"
-#include "Application.hpp"
+#include "physics/SimClock.hpp"
+#include "JobSystem.hpp"
+#include "physics/EnsembleIntegrator.hpp"
 
-#include <execution>
 #include <algorithm>
+#include <cmath>
 #include <glm/gtx/norm.hpp>
 
-void SimPhysics::ProgressAllOneStep(std::vector<std::unique_ptr<Planet>>& planets)
+void SimPhysics::AccelerateAll(BodyStore& bodies, float timeScale, const std::vector<uint8_t>* skipMask, ConservationStats* outStats,
+	std::vector<double>* pairScratch, float gMultiplier)
 {
-	for (auto& planet : planets)
+	const std::vector<glm::vec3>& positions = bodies.Positions;
+	const std::vector<float>& masses = bodies.Masses;
+	std::vector<glm::vec3>& velocities = bodies.Velocities;
+	uint32_t count = (uint32_t)bodies.Size();
+
+	auto isSkipped = [skipMask](uint32_t idx) { return skipMask && (*skipMask)[idx]; };
+
+	// Plain buffer instead of a thread_local, chunks below run on other threads and must all write into this one
+	std::vector<double> ownPairPotentials;
+	std::vector<double>& pairPotentials = pairScratch ? *pairScratch : ownPairPotentials;
+
+	if (outStats)
 	{
-		if (planet->GetPhysics().Mass <= 0.0f)
-		{
-			continue;
-		}
+		// Velocities get overwritten below, the per-body terms need them as they were
+		*outStats = ConservationStats{};
+		AccumulateBodyTerms(bodies, *outStats);
+		pairPotentials.assign(count, 0.0);
+	}
 
-		std::for_each(std::execution::par, planets.begin(), planets.end(), [&](std::unique_ptr<Planet>& other)
+	// Every body only writes its own velocity, so chunks never touch each other's data
+	JobSystem::ParallelFor(0, count, BODIES_PER_JOB, [&](uint32_t chunkBegin, uint32_t chunkEnd)
+		{
+			for (uint32_t i = chunkBegin; i < chunkEnd; i++)
 			{
-				if (other == planet || other->GetPhysics().Mass <= 0.0f)
+				if (masses[i] <= 0.0f || isSkipped(i))
 				{
-					return;
+					continue;
+				}
+
+				glm::vec3 linVel = velocities[i];
+				double pairPotential = 0.0;
+
+				for (uint32_t j = 0; j < count; j++)
+				{
+					if (j == i || masses[j] <= 0.0f)
+					{
+						continue;
+					}
+
+					glm::dvec3 dir = glm::normalize(positions[j] - positions[i]);
+					double distance2 = glm::distance2(positions[i], positions[j]);
+
+					if (distance2 <= 0.0f)
+					{
+						continue;
+					}
+
+					double mass1 = (double)masses[i];
+					double mass2 = (double)masses[j];
+
+					glm::dvec3 F = dir * mass1 * mass2 / distance2;
+					F *= (double)gMultiplier * SCALE_FACTOR;
+					glm::dvec3 addAccel = F / (mass1 * SUN_MASS);
+					glm::vec3 fAddAccel = addAccel;
+
+					linVel = linVel + (SimClock::TPS_STEP * timeScale * fAddAccel);
+
+					// Both bodies of a pair see it, unless the other one sits this pass out
+					if (outStats)
+					{
+						pairPotential += (isSkipped(j) ? 1.0 : 0.5) * mass1 * mass2 / std::sqrt(distance2);
+					}
 				}
 
-				glm::dvec3 dir = glm::normalize(other->GetTransform().Position - planet->GetTransform().Position);
-				double distance2 = glm::distance2(planet->GetTransform().Position, other->GetTransform().Position);
+				velocities[i] = linVel;
 
-				if (distance2 <= 0.0f)
+				if (outStats)
 				{
-					return;
+					pairPotentials[i] = pairPotential;
 				}
+			}
+		});
+
+	if (!outStats)
+	{
+		return;
+	}
 
-				double mass1 = (double)planet->GetPhysics().Mass;
-				double mass2 = (double)other->GetPhysics().Mass;
+	// Serial sum in body order, so the result doesn't depend on how the pass got split up
+	double potential = 0.0;
 
-				glm::dvec3 F = dir * mass1 * mass2 / distance2;
-				F *= (double)G_CONSTANT_MULTIPLIER * SCALE_FACTOR;
-				glm::dvec3 addAccel = F / (mass1 * SUN_MASS);
-				glm::vec3 fAddAccel = addAccel;
+	for (uint32_t i = 0; i < count; i++)
+	{
+		potential += pairPotentials[i];
+	}
+
+	// Pairs where both bodies skipped the pass, usually just a handful
+	if (skipMask)
+	{
+		for (uint32_t i = 0; i < count; i++)
+		{
+			for (uint32_t j = i + 1; j < count && isSkipped(i); j++)
+			{
+				double distance2 = glm::distance2(positions[i], positions[j]);
+
+				if (isSkipped(j) && distance2 > 0.0)
+				{
+					potential += (double)std::max(masses[i], 0.0f) * std::max(masses[j], 0.0f) / std::sqrt(distance2);
+				}
+			}
+		}
+	}
 
-				glm::vec3 linVel = planet->GetPhysics().LinearVelocity;
-				planet->GetPhysics().LinearVelocity = linVel + (Application::TPS_STEP * Application::TPS_MULTIPLIER * fAddAccel);
-			});
-	}				  
-}					  
+	outStats->Potential = -(double)gMultiplier * SCALE_FACTOR / SUN_MASS * potential;
+}
 
-std::vector<glm::vec3> SimPhysics::ApproximateNextNPoints(std::vector<std::unique_ptr<Planet>>& planets, Planet* target, uint32_t N)
+ConservationStats SimPhysics::MeasureConservation(const BodyStore& bodies, float gMultiplier)
 {
-	float tpsMultiplier = Application::TPS_MULTIPLIER;
-	Application::TPS_MULTIPLIER = 100.0f;
+	ConservationStats stats;
+	double potential = 0.0;
 
-	std::vector<glm::vec3> points;
-	std::vector<std::unique_ptr<Planet>> planetsCopy;
+	AccumulateBodyTerms(bodies, stats);
 
-	planetsCopy.reserve(planets.size());
+	for (size_t i = 0; i < bodies.Size(); i++)
+	{
+		for (size_t j = i + 1; j < bodies.Size(); j++)
+		{
+			double distance2 = glm::distance2(bodies.Positions[i], bodies.Positions[j]);
 
-	for (auto& planet : planets)
+			// Clamped like AccumulateBodyTerms does, the force pass skips bodies without a positive mass altogether
+			if (distance2 > 0.0)
+			{
+				potential += (double)std::max(bodies.Masses[i], 0.0f) * std::max(bodies.Masses[j], 0.0f) / std::sqrt(distance2);
+			}
+		}
+	}
+
+	stats.Potential = -(double)gMultiplier * SCALE_FACTOR / SUN_MASS * potential;
+
+	return stats;
+}
+
+void SimPhysics::AccumulateBodyTerms(const BodyStore& bodies, ConservationStats& stats)
+{
+	for (size_t i = 0; i < bodies.Size(); i++)
 	{
-		planetsCopy.push_back(planet->Clone());
+		double mass = (double)std::max(bodies.Masses[i], 0.0f);
+		glm::dvec3 velocity = bodies.Velocities[i];
+		glm::dvec3 momentum = mass * velocity;
+
+		stats.Kinetic += 0.5 * (double)VELOCITY_SCALE * mass * glm::dot(velocity, velocity);
+		stats.Momentum += momentum;
+		stats.AngularMomentum += glm::cross(glm::dvec3(bodies.Positions[i]), momentum);
+		stats.MomentumScale += glm::length(momentum);
 	}
+}
+
+void SimPhysics::FindEscapingBodies(const BodyStore& bodies, float radius, const std::vector<uint8_t>* inactiveMask, std::vector<uint32_t>& outEscaping,
+	float gMultiplier)
+{
+	auto isInactive = [inactiveMask](size_t idx) { return inactiveMask && (*inactiveMask)[idx]; };
 
-	SceneObject::CleanLastNIDs(planetsCopy.size());
+	double totalMass = 0.0;
+	glm::dvec3 weightedPosition(0.0);
+	glm::dvec3 weightedVelocity(0.0);
 
-	Planet* targetCopy = nullptr;
-	
-	for (size_t i = 0; i < planets.size(); i++)
+	for (size_t i = 0; i < bodies.Size(); i++)
 	{
-		if (planets[i].get() == target)
+		if (isInactive(i) || bodies.Masses[i] <= 0.0f)
 		{
-			targetCopy = planetsCopy[i].get();
-			break;
+			continue;
 		}
+
+		double mass = (double)bodies.Masses[i];
+
+		totalMass += mass;
+		weightedPosition += mass * glm::dvec3(bodies.Positions[i]);
+		weightedVelocity += mass * glm::dvec3(bodies.Velocities[i]);
 	}
-	
-	points.reserve(N);
-	points.emplace_back(targetCopy->GetTransform().Position);
 
-	for (uint32_t i = 0; i < N * 10; i++)
+	double K = (double)gMultiplier * SCALE_FACTOR / SUN_MASS;
+	double c = (double)VELOCITY_SCALE;
+	double radius2 = (double)radius * radius;
+
+	for (size_t i = 0; i < bodies.Size(); i++)
 	{
-		ProgressAllOneStep(planetsCopy);
+		if (isInactive(i))
+		{
+			continue;
+		}
 
-		for (auto& planet : planetsCopy)
+		// Barycenter of everything but the body itself, one pass over the totals instead of one per body
+		double mass = (double)std::max(bodies.Masses[i], 0.0f);
+		double restMass = totalMass - mass;
+
+		if (restMass <= 0.0)
 		{
-			planet->OnTick();
+			continue;
 		}
 
-		if (i % 2 == 0)
+		glm::dvec3 restPosition = (weightedPosition - mass * glm::dvec3(bodies.Positions[i])) / restMass;
+		glm::dvec3 restVelocity = (weightedVelocity - mass * glm::dvec3(bodies.Velocities[i])) / restMass;
+
+		glm::dvec3 offset = glm::dvec3(bodies.Positions[i]) - restPosition;
+		glm::dvec3 rate = c * (glm::dvec3(bodies.Velocities[i]) - restVelocity);
+		double distance2 = glm::dot(offset, offset);
+
+		if (distance2 <= radius2 || glm::dot(offset, rate) <= 0.0)
+		{
+			continue;
+		}
+
+		// Two body energy against the rest of the system, in the same position rate units Kepler orbits use
+		double mu = c * K * (restMass + mass);
+		double energy = 0.5 * glm::dot(rate, rate) - mu / std::sqrt(distance2);
+
+		if (energy > 0.0)
 		{
-			points.emplace_back(targetCopy->GetTransform().Position);
+			outEscaping.push_back((uint32_t)i);
 		}
 	}
+}
 
-	Application::TPS_MULTIPLIER = tpsMultiplier;
-	return points;
+void SimPhysics::MoveAll(BodyStore& bodies, float timeScale)
+{
+	for (size_t i = 0; i < bodies.Size(); i++)
+	{
+		glm::vec3 move = bodies.Velocities[i] * SimClock::TPS_STEP * timeScale;
+
+		bodies.Positions[i] += move * VELOCITY_SCALE;
+	}
+}
+
+void SimPhysics::StepBodies(BodyStore& bodies, float timeScale, float gMultiplier)
+{
+	AccelerateAll(bodies, timeScale, nullptr, nullptr, nullptr, gMultiplier);
+	MoveAll(bodies, timeScale);
 }
 
-std::vector<glm::vec3> SimPhysics::ApproximateRelativeNextNPoints(std::vector<std::unique_ptr<Planet>>& planets, Planet* target, uint32_t N)
+std::vector<glm::vec3> SimPhysics::ApproximateNextNPoints(BodyStore& bodies, size_t targetIdx, uint32_t N,
+	const std::function<bool(void)>& isCancelled, const PathProgressFunc& onProgress, const PathSampler::Spec& sampling)
 {
-	float tpsMultiplier = Application::TPS_MULTIPLIER;
-	Application::TPS_MULTIPLIER = 100.0f;
+	std::vector<glm::vec3> points;
+	PathSampler sampler(points, sampling);
 
-	Planet* parent = target->GetRelativePlanet();
+	sampler.Feed(bodies.Positions[targetIdx]);
 
-	if (parent == nullptr)
+	for (uint32_t i = 0; i < N * 10 && !sampler.IsFull(); i++)
 	{
-		return {};
-	}
+		if (isCancelled && isCancelled())
+		{
+			return {};
+		}
 
-	std::vector<glm::vec3> relToPlanetVectors;
-	std::vector<std::unique_ptr<Planet>> planetsCopy;
+		StepBodies(bodies, PREDICTION_TIME_SCALE);
 
-	planetsCopy.reserve(planets.size());
+		if (sampler.Feed(bodies.Positions[targetIdx]) && onProgress)
+		{
+			onProgress(points);
+		}
+	}
 
-	for (auto& planet : planets)
+	if (sampler.Finish() && onProgress)
 	{
-		planetsCopy.push_back(planet->Clone());
+		onProgress(points);
 	}
 
-	SceneObject::CleanLastNIDs(planetsCopy.size());
+	return points;
+}
 
-	Planet* targetCopy = nullptr;
-	Planet* targetRelCopy = nullptr;
+std::vector<glm::vec3> SimPhysics::ApproximateRelativeNextNPoints(BodyStore& bodies, size_t targetIdx, size_t parentIdx, uint32_t N,
+	const std::function<bool(void)>& isCancelled, const PathProgressFunc& onProgress, const PathSampler::Spec& sampling)
+{
+	std::vector<glm::vec3> relToPlanetVectors;
+	PathSampler sampler(relToPlanetVectors, sampling);
 
-	for (size_t i = 0; i < planets.size(); i++)
+	sampler.Feed(bodies.Positions[targetIdx] - bodies.Positions[parentIdx]);
+
+	for (uint32_t i = 0; i < N * 10 && !sampler.IsFull(); i++)
 	{
-		if (planets[i].get() == target)
+		if (isCancelled && isCancelled())
 		{
-			targetCopy = planetsCopy[i].get();
+			return {};
 		}
-		else if (planets[i].get() == parent)
+
+		StepBodies(bodies, PREDICTION_TIME_SCALE);
+
+		if (sampler.Feed(bodies.Positions[targetIdx] - bodies.Positions[parentIdx]) && onProgress)
 		{
-			targetRelCopy = planetsCopy[i].get();
+			onProgress(relToPlanetVectors);
 		}
 	}
-	
-	relToPlanetVectors.reserve(N);
-	relToPlanetVectors.emplace_back(targetCopy->GetTransform().Position - targetRelCopy->GetTransform().Position);
-			 
-	for (uint32_t i = 0; i < N * 10; i += 2)
+
+	if (sampler.Finish() && onProgress)
 	{
-		ProgressAllOneStep(planetsCopy);
+		onProgress(relToPlanetVectors);
+	}
+
+	return relToPlanetVectors;
+}
+
+std::vector<std::vector<glm::vec3>> SimPhysics::ApproximateEnsembleNextNPoints(const BodyStore& bodies, size_t targetIdx, int32_t parentIdx, uint32_t N,
+	uint32_t members, float spreadAngle, const std::function<bool(void)>& isCancelled, const PathSampler::Spec& sampling)
+{
+	EnsembleIntegrator ensemble(bodies, targetIdx, members, spreadAngle);
+	std::vector<std::vector<glm::vec3>> paths(ensemble.GetMemberCount());
+	std::vector<PathSampler> samplers;
+
+	samplers.reserve(paths.size());
 
-		for (auto& planet : planetsCopy)
+	auto memberPoint = [&](uint32_t member)
 		{
-			planet->OnTick();
+			glm::vec3 point = ensemble.GetPosition(targetIdx, member);
+
+			return parentIdx < 0 ? point : point - ensemble.GetPosition((size_t)parentIdx, member);
+		};
+
+	for (uint32_t k = 0; k < ensemble.GetMemberCount(); k++)
+	{
+		samplers.emplace_back(paths[k], sampling);
+		samplers[k].Feed(memberPoint(k));
+	}
+
+	for (uint32_t i = 0; i < N * 10; i++)
+	{
+		if (isCancelled && isCancelled())
+		{
+			return {};
+		}
+
+		ensemble.Step(PREDICTION_TIME_SCALE);
+
+		// Members share the integration even after some of them ran out of points, sampling is the only thing skipped
+		bool allFull = true;
+
+		for (uint32_t k = 0; k < ensemble.GetMemberCount(); k++)
+		{
+			samplers[k].Feed(memberPoint(k));
+			allFull = allFull && samplers[k].IsFull();
+		}
+
+		if (allFull)
+		{
+			break;
 		}
+	}
 
-		relToPlanetVectors.emplace_back(targetCopy->GetTransform().Position - targetRelCopy->GetTransform().Position);
+	for (PathSampler& sampler : samplers)
+	{
+		sampler.Finish();
 	}
 
-	Application::TPS_MULTIPLIER = tpsMultiplier;
-			 
-	return relToPlanetVectors;
-}
+	return paths;
+}
\ No newline at end of file
@@ -1,15 +1,49 @@
 #pragma once
 
-#include "objects/Planet.hpp"
+#include "physics/BodyStore.hpp"
+#include "physics/PathSampler.hpp"
+#include "physics/Conservation.hpp"
+
+#include <glm/gtc/constants.hpp>
 
 #include <vector>
+#include <functional>
+
+using PathProgressFunc = std::function<void(const std::vector<glm::vec3>&)>;
 
 class SimPhysics
 {
 public:
-	static void ProgressAllOneStep(std::vector<std::unique_ptr<Planet>>& planets);
-	static std::vector<glm::vec3> ApproximateNextNPoints(std::vector<std::unique_ptr<Planet>>& planets, Planet* target, uint32_t N);
-	static std::vector<glm::vec3> ApproximateRelativeNextNPoints(std::vector<std::unique_ptr<Planet>>& planets, Planet* target, uint32_t N);
+	// Bodies flagged in skipMask keep their velocity, they still pull on the others.
+	// With outStats set the conserved quantities of the state before the step come along, reusing the pass' distances.
+	// They need a per-body buffer, pairScratch lets the caller keep one across steps instead of allocating it every call.
+	// gMultiplier defaults to the one set in the UI, integrators that log their own settings pass theirs.
+	static void AccelerateAll(BodyStore& bodies, float timeScale, const std::vector<uint8_t>* skipMask = nullptr, ConservationStats* outStats = nullptr,
+		std::vector<double>* pairScratch = nullptr, float gMultiplier = G_CONSTANT_MULTIPLIER);
+
+	// Same quantities on their own, with a pairwise loop of their own
+	static ConservationStats MeasureConservation(const BodyStore& bodies, float gMultiplier = G_CONSTANT_MULTIPLIER);
+	static void MoveAll(BodyStore& bodies, float timeScale);
+
+	// Appends bodies further than radius from the barycenter of the rest, moving away from it and no longer bound to it.
+	// Bodies flagged in inactiveMask are neither checked nor count towards the rest.
+	static void FindEscapingBodies(const BodyStore& bodies, float radius, const std::vector<uint8_t>* inactiveMask, std::vector<uint32_t>& outEscaping,
+		float gMultiplier = G_CONSTANT_MULTIPLIER);
+	static void StepBodies(BodyStore& bodies, float timeScale, float gMultiplier = G_CONSTANT_MULTIPLIER);
+
+	// Both integrate the given bodies in place for N * 10 steps, so they get a copy of the scene's snapshot.
+	// Points are picked by the sampler from every step, the path ends early once its point budget runs out.
+	// They return an empty path once isCancelled reports true, it's polled between steps.
+	// onProgress sees the path computed so far every time a point gets appended.
+	static std::vector<glm::vec3> ApproximateNextNPoints(BodyStore& bodies, size_t targetIdx, uint32_t N,
+		const std::function<bool(void)>& isCancelled = {}, const PathProgressFunc& onProgress = {}, const PathSampler::Spec& sampling = {});
+	static std::vector<glm::vec3> ApproximateRelativeNextNPoints(BodyStore& bodies, size_t targetIdx, size_t parentIdx, uint32_t N,
+		const std::function<bool(void)>& isCancelled = {}, const PathProgressFunc& onProgress = {}, const PathSampler::Spec& sampling = {});
+
+	// Paths of the target in every member of a perturbed ensemble, see EnsembleIntegrator. Member 0 is the unperturbed one.
+	// Paths are relative to parentIdx unless it's negative, an empty result means the run was cancelled.
+	static std::vector<std::vector<glm::vec3>> ApproximateEnsembleNextNPoints(const BodyStore& bodies, size_t targetIdx, int32_t parentIdx, uint32_t N,
+		uint32_t members, float spreadAngle, const std::function<bool(void)>& isCancelled = {}, const PathSampler::Spec& sampling = {});
 
 	static inline constexpr double G_CONSTANT = 6.674e-11;
 	static inline float G_CONSTANT_MULTIPLIER = 1.0f;
@@ -22,4 +56,17 @@ public:
 
 	// Factor to scale forces by
 	static inline constexpr double SCALE_FACTOR = (G_CONSTANT * SUN_MASS * SUN_MASS) / (SUN_TO_EARTH_DIST * SUN_TO_EARTH_DIST);
+
+	// Turns velocity into distance covered per unit of simulated time
+	static inline constexpr float VELOCITY_SCALE = 20.0f * glm::pi<float>() / 365.0f;
+
+	// Time scale predictions step with, coarser than the live simulation to look further ahead
+	static inline constexpr float PREDICTION_TIME_SCALE = 100.0f;
+
+	// How many bodies a single physics job integrates
+	static inline constexpr uint32_t BODIES_PER_JOB = 16;
+
+private:
+	// Kinetic energy, momentum and angular momentum, everything that doesn't need pairs
+	static void AccumulateBodyTerms(const BodyStore& bodies, ConservationStats& stats);
 };
\ No newline at end of file
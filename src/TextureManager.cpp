@@ -3,8 +3,19 @@
 #include "stb_image/stb_image.h"
 #include "Logger.hpp"
 #include "Timer.hpp"
+#include "JobSystem.hpp"
 
 #include <filesystem>
+#include <unordered_set>
+
+namespace
+{
+	struct DecodedImage
+	{
+		uint8_t* Buffer = nullptr;
+		int32_t Width{}, Height{}, BPP{};
+	};
+}
 
 std::unique_ptr<Texture> TextureManager::s_Atlas;
 std::vector<TextureInfo> TextureManager::s_Textures;
@@ -24,12 +35,14 @@ void TextureManager::Init()
 	AddDefaults();
 	s_IndexCounter = DEFAULT_SPECULAR + 1;
 
-	AddTexture("res/textures/icons/new-planet.png");
-	AddTexture("res/textures/icons/new-sun.png");
-	AddTexture("res/textures/icons/play.png");
-	AddTexture("res/textures/icons/pause.png");
-	AddTexture("res/textures/icons/stop.png");
-	AddTexture("res/textures/icons/settings.png");
+	AddTextures({
+		"res/textures/icons/new-planet.png",
+		"res/textures/icons/new-sun.png",
+		"res/textures/icons/play.png",
+		"res/textures/icons/pause.png",
+		"res/textures/icons/stop.png",
+		"res/textures/icons/settings.png"
+	});
 }
 
 void TextureManager::ReInit()
@@ -55,45 +68,106 @@ std::optional<TextureInfo> TextureManager::AddTexture(const std::string& path)
 		return *texItr;
 	}
 
-	stbi_set_flip_vertically_on_load(0);
-	int32_t width{}, height{}, bpp{};
-	uint8_t* buffer = stbi_load(path.c_str(), &width, &height, &bpp, 4);
+	size_t textureCount = s_Textures.size();
+	AddTextures({ path });
 
-	if (buffer == nullptr)
+	if (s_Textures.size() == textureCount)
 	{
 		return {};
 	}
 
-	stbrp_rect texRect{};
-	texRect.id = s_IndexCounter;
-	texRect.w = width;
-	texRect.h = height;
-	s_Rects.push_back(texRect);
-	s_IndexCounter++;
+	return s_Textures.back();
+}
 
-	if (stbrp_pack_rects(&s_Context, s_Rects.data(), s_Rects.size()))
+void TextureManager::AddTextures(const std::vector<std::string>& paths)
+{
+	FUNC_PROFILE();
+
+	// Each file gets decoded once, no matter how many objects use it
+	std::vector<std::string> newPaths;
+	std::unordered_set<std::string> seen;
+
+	for (const std::string& path : paths)
 	{
-		LOG_INFO("Added texture");
+		if (seen.insert(path).second && !GetTexture(path).has_value())
+		{
+			newPaths.push_back(path);
+		}
+	}
 
-		texRect = s_Rects.back();
+	if (newPaths.empty())
+	{
+		return;
+	}
 
-		s_Atlas->SetSubtexture(buffer, { texRect.x, texRect.y }, { texRect.w, texRect.h });
-		s_Textures.push_back({ texRect.id, std::filesystem::relative(path).string(),
-			{ texRect.x / (float)s_Atlas->GetWidth(), texRect.y / (float)s_Atlas->GetHeight() },
-			{ texRect.w / (float)s_Atlas->GetWidth(), texRect.h / (float)s_Atlas->GetHeight() } });
+	// Decoding is the slow part and doesn't touch GL, so it's spread over the workers.
+	// Packing and uploading stay on this thread.
+	std::vector<DecodedImage> images(newPaths.size());
+	stbi_set_flip_vertically_on_load(0);
 
-		stbi_image_free(buffer);
+	JobSystem::ParallelFor(0, (uint32_t)newPaths.size(), 1, [&](uint32_t chunkBegin, uint32_t chunkEnd)
+		{
+			for (uint32_t i = chunkBegin; i < chunkEnd; i++)
+			{
+				DecodedImage& image = images[i];
+				image.Buffer = stbi_load(newPaths[i].c_str(), &image.Width, &image.Height, &image.BPP, 4);
+			}
+		});
+
+	int32_t firstNewId = s_IndexCounter;
+	size_t firstNewRect = s_Rects.size();
+	size_t firstNewTexture = s_Textures.size();
+
+	for (size_t i = 0; i < newPaths.size(); i++)
+	{
+		if (images[i].Buffer == nullptr)
+		{
+			LOG_WARN("Texture {} could not be loaded.", newPaths[i]);
+
+			continue;
+		}
+
+		stbrp_rect texRect{};
+		texRect.id = s_IndexCounter;
+		texRect.w = images[i].Width;
+		texRect.h = images[i].Height;
+		s_Rects.push_back(texRect);
+		s_Textures.push_back({ texRect.id, std::filesystem::relative(newPaths[i]).string(), {}, {} });
+		s_IndexCounter++;
 	}
-	else
+
+	if (s_Rects.size() == firstNewRect)
 	{
-		s_Textures.push_back({ texRect.id, std::filesystem::relative(path).string(),
-			{ texRect.x / (float)s_Atlas->GetWidth(), texRect.y / (float)s_Atlas->GetHeight() },
-			{ texRect.w / (float)s_Atlas->GetWidth(), texRect.h / (float)s_Atlas->GetHeight() } });
+		return;
+	}
 
-		GrowAtlas();
+	// Only the new rects get packed, the ones already in the atlas keep their space
+	if (!stbrp_pack_rects(&s_Context, s_Rects.data() + firstNewRect, s_Rects.size() - firstNewRect))
+	{
+		GrowAtlas(firstNewId);
 	}
 
-	return s_Textures.back();
+	size_t rectIdx = firstNewRect;
+	size_t textureIdx = firstNewTexture;
+
+	for (DecodedImage& image : images)
+	{
+		if (image.Buffer == nullptr)
+		{
+			continue;
+		}
+
+		const stbrp_rect& texRect = s_Rects[rectIdx++];
+		TextureInfo& tex = s_Textures[textureIdx++];
+
+		s_Atlas->SetSubtexture(image.Buffer, { texRect.x, texRect.y }, { texRect.w, texRect.h });
+		tex.UV = { texRect.x / (float)s_Atlas->GetWidth(), texRect.y / (float)s_Atlas->GetHeight() };
+		tex.Size = { texRect.w / (float)s_Atlas->GetWidth(), texRect.h / (float)s_Atlas->GetHeight() };
+
+		stbi_image_free(image.Buffer);
+	}
+
+	LOG_INFO("Added {} textures.", s_Rects.size() - firstNewRect);
 }
 
 std::optional<TextureInfo> TextureManager::GetTexture(const std::string& path)
@@ -198,7 +272,7 @@ void TextureManager::AddDefaults()
 		{ rect.w / (float)s_Atlas->GetWidth(), rect.h / (float)s_Atlas->GetHeight() } });
 }
 
-void TextureManager::GrowAtlas()
+void TextureManager::GrowAtlas(int32_t decodedFromId)
 {
 	std::vector<stbrp_rect> rectsCopy = s_Rects;
 	
@@ -251,16 +325,29 @@ void TextureManager::GrowAtlas()
 		{ rect.x / (float)s_Atlas->GetWidth(), rect.y / (float)s_Atlas->GetHeight() },
 		{ rect.w / (float)s_Atlas->GetWidth(), rect.h / (float)s_Atlas->GetHeight() } };
 
-	for (TextureInfo& tex : s_Textures)
-	{
-		if (tex.TextureID < 4)
+	// Decoding is the slow part and doesn't touch GL, so it's spread over the workers.
+	// Uploading to the atlas stays on this thread.
+	std::vector<DecodedImage> images(s_Textures.size());
+	stbi_set_flip_vertically_on_load(0);
+
+	JobSystem::ParallelFor(0, (uint32_t)s_Textures.size(), 1, [&](uint32_t chunkBegin, uint32_t chunkEnd)
 		{
-			continue;
-		}
+			for (uint32_t i = chunkBegin; i < chunkEnd; i++)
+			{
+				if (s_Textures[i].TextureID < 4 || s_Textures[i].TextureID >= decodedFromId)
+				{
+					continue;
+				}
+
+				DecodedImage& image = images[i];
+				image.Buffer = stbi_load(s_Textures[i].Path.c_str(), &image.Width, &image.Height, &image.BPP, 4);
+			}
+		});
 
-		stbi_set_flip_vertically_on_load(0);
-		int32_t width{}, height{}, bpp{};
-		uint8_t* buffer = stbi_load(tex.Path.c_str(), &width, &height, &bpp, 4);
+	for (size_t i = 0; i < s_Textures.size(); i++)
+	{
+		TextureInfo& tex = s_Textures[i];
+		uint8_t* buffer = images[i].Buffer;
 
 		if (buffer == nullptr)
 		{
@@ -278,4 +365,4 @@ void TextureManager::GrowAtlas()
 
 		stbi_image_free(buffer);
 	}
-}
+}
\ No newline at end of file
@@ -3,6 +3,7 @@
 #include <string>
 #include <optional>
 #include <vector>
+#include <cstdint>
 
 #include "stb_rect_pack/stb_rect_pack.h"
 #include "OpenGL.hpp"
@@ -24,6 +25,10 @@ public:
 
 	static std::optional<TextureInfo> AddTexture(const std::string& path);
 
+	// Decodes every path not in the atlas yet on the workers, then packs and uploads them all in one go.
+	// Ids go out in the order of paths, files that fail to decode get none.
+	static void AddTextures(const std::vector<std::string>& paths);
+
 	static std::optional<TextureInfo> GetTexture(const std::string& path);
 	static std::optional<TextureInfo> GetTexture(uint32_t id);
 
@@ -46,7 +51,8 @@ private:
 	TextureManager() = default;
 
 	static void AddDefaults();
-	static void GrowAtlas();
+	// Textures from decodedFromId on are left out of the re-upload, the caller still has them decoded
+	static void GrowAtlas(int32_t decodedFromId = INT32_MAX);
 
 	static std::unique_ptr<Texture> s_Atlas;
 	static std::vector<TextureInfo> s_Textures;
@@ -0,0 +1,213 @@
+#include "TrajectoryPredictor.hpp"
+#include "Simulator.hpp"
+#include "scenes/PlanetBodies.hpp"
+#include "physics/PararealIntegrator.hpp"
+
+#include <algorithm>
+
+TrajectoryPredictor::~TrajectoryPredictor()
+{
+	Cancel();
+	JobSystem::Wait(m_Job);
+
+	delete m_Ready.exchange(nullptr);
+	delete m_ReadySpread.exchange(nullptr);
+	delete m_Spare.exchange(nullptr);
+}
+
+void TrajectoryPredictor::Request(std::vector<std::unique_ptr<Planet>>& planets, Planet* target, uint32_t N, const PredictionOptions& options)
+{
+	auto targetIt = std::find_if(planets.begin(), planets.end(), [target](const std::unique_ptr<Planet>& planet) { return planet.get() == target; });
+
+	if (targetIt == planets.end())
+	{
+		return;
+	}
+
+	// Reusing the last finished request keeps the snapshot's buffers, so dragging a velocity doesn't allocate every frame
+	PredictionRequest* request = m_Spare.exchange(nullptr);
+
+	if (request == nullptr)
+	{
+		request = new PredictionRequest();
+	}
+
+	PlanetBodies::TakeSnapshot(planets, request->Bodies);
+	request->TargetIdx = targetIt - planets.begin();
+	request->Relative = false;
+	request->N = N;
+	request->Options = options;
+
+	if (Planet* parent = target->GetRelativePlanet())
+	{
+		auto parentIt = std::find_if(planets.begin(), planets.end(), [parent](const std::unique_ptr<Planet>& planet) { return planet.get() == parent; });
+
+		if (parentIt != planets.end())
+		{
+			request->ParentIdx = parentIt - planets.begin();
+			request->Relative = true;
+		}
+	}
+
+	request->Generation = ++m_Generation;
+	Recycle(m_Pending.exchange(request));
+
+	if (m_WorkerActive.exchange(true))
+	{
+		// Running worker picks the request up once its current one bails out
+		return;
+	}
+
+	// Chained onto the previous worker, which may still be on its way out, so waiting on m_Job covers every worker
+	m_Job = JobSystem::Submit([this]() { Work(); }, { m_Job });
+}
+
+void TrajectoryPredictor::Cancel()
+{
+	++m_Generation;
+	Recycle(m_Pending.exchange(nullptr));
+}
+
+bool TrajectoryPredictor::Poll(std::vector<glm::vec3>& outPath)
+{
+	PredictionResult* result = m_Ready.exchange(nullptr);
+
+	if (result == nullptr)
+	{
+		return false;
+	}
+
+	if (result->Restart)
+	{
+		outPath = std::move(result->Points);
+	}
+	else
+	{
+		outPath.insert(outPath.end(), result->Points.begin(), result->Points.end());
+	}
+
+	delete result;
+
+	return true;
+}
+
+bool TrajectoryPredictor::PollSpread(std::vector<std::vector<glm::vec3>>& outPaths)
+{
+	SpreadResult* result = m_ReadySpread.exchange(nullptr);
+
+	if (result == nullptr)
+	{
+		return false;
+	}
+
+	outPaths = std::move(result->Paths);
+	delete result;
+
+	return true;
+}
+
+void TrajectoryPredictor::Work()
+{
+	while (true)
+	{
+		PredictionRequest* request = m_Pending.exchange(nullptr);
+
+		if (request == nullptr)
+		{
+			m_WorkerActive = false;
+
+			// A request might have landed between the exchange above and clearing the flag
+			if (m_Pending.load() == nullptr || m_WorkerActive.exchange(true))
+			{
+				return;
+			}
+
+			continue;
+		}
+
+		uint64_t generation = request->Generation;
+		auto isCancelled = [this, generation]() { return m_Generation.load() != generation; };
+
+		size_t published = 0;
+
+		auto onProgress = [this, &isCancelled, &published](const std::vector<glm::vec3>& points)
+			{
+				if (points.size() % POINTS_PER_CHUNK == 0 && !isCancelled())
+				{
+					Publish(points, published);
+					published = points.size();
+				}
+			};
+
+		// Main path integrates the snapshot in place, the ensemble needs the starting state
+		BodyStore spreadStart;
+
+		const PredictionOptions& options = request->Options;
+		int32_t parentIdx = request->Relative ? (int32_t)request->ParentIdx : -1;
+
+		if (options.EnsembleMembers > 1)
+		{
+			spreadStart = request->Bodies;
+		}
+
+		std::vector<glm::vec3> points;
+
+		if (options.Parareal)
+		{
+			PathSampler::Spec sampling;
+			sampling.MaxPoints = PARAREAL_MAX_POINTS;
+
+			points = PararealIntegrator({}).Run(request->Bodies, request->N * 10, SimPhysics::PREDICTION_TIME_SCALE,
+				request->TargetIdx, parentIdx, sampling, isCancelled);
+		}
+		else if (request->Relative)
+		{
+			points = SimPhysics::ApproximateRelativeNextNPoints(request->Bodies, request->TargetIdx, request->ParentIdx, request->N, isCancelled, onProgress);
+		}
+		else
+		{
+			points = SimPhysics::ApproximateNextNPoints(request->Bodies, request->TargetIdx, request->N, isCancelled, onProgress);
+		}
+
+		// Chunked paths already published everything but a partial last chunk, parareal ones nothing yet
+		if (!isCancelled() && points.size() > published)
+		{
+			Publish(points, published);
+		}
+
+		if (!isCancelled() && options.EnsembleMembers > 1)
+		{
+			std::vector<std::vector<glm::vec3>> spread = SimPhysics::ApproximateEnsembleNextNPoints(spreadStart, request->TargetIdx,
+				parentIdx, request->N, options.EnsembleMembers, options.SpreadAngle, isCancelled);
+
+			if (!isCancelled())
+			{
+				delete m_ReadySpread.exchange(new SpreadResult{ std::move(spread) });
+			}
+		}
+
+		Recycle(request);
+	}
+}
+
+void TrajectoryPredictor::Publish(const std::vector<glm::vec3>& points, size_t fromPoint)
+{
+	// Only the new points get copied. A result the UI hasn't taken yet gets them appended,
+	// unless they start a new path, then whatever is left of the old one is worthless.
+	PredictionResult* result = m_Ready.exchange(nullptr);
+
+	if (result == nullptr || fromPoint == 0)
+	{
+		delete result;
+		result = new PredictionResult();
+		result->Restart = fromPoint == 0;
+	}
+
+	result->Points.insert(result->Points.end(), points.begin() + fromPoint, points.end());
+	delete m_Ready.exchange(result);
+}
+
+void TrajectoryPredictor::Recycle(PredictionRequest* request)
+{
+	delete m_Spare.exchange(request);
+}
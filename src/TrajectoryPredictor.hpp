@@ -0,0 +1,87 @@
+#pragma once
+
+#include "JobSystem.hpp"
+#include "physics/BodyStore.hpp"
+
+#include <glm/glm.hpp>
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+class Planet;
+
+struct PredictionOptions
+{
+	// Above 1 a spread of perturbed paths gets computed after the main one
+	uint32_t EnsembleMembers = 0;
+	float SpreadAngle = 0.0f;
+
+	// Integrates the horizon in parallel time slices, the path then arrives in one piece instead of chunks
+	bool Parareal = false;
+};
+
+// Runs path predictions in the background, always for the newest request.
+// A request issued while another one is being computed cancels it between two steps.
+// Scene state is copied into a plain snapshot at request time, the worker never looks at the scene.
+// Paths are handed over through a lock-free slot in chunks while they're still being computed,
+// so the start of a path shows up long before its end is known.
+class TrajectoryPredictor
+{
+public:
+	TrajectoryPredictor() = default;
+	~TrajectoryPredictor();
+
+	void Request(std::vector<std::unique_ptr<Planet>>& planets, Planet* target, uint32_t N, const PredictionOptions& options = {});
+	void Cancel();
+
+	// Appends points published since the last call to outPath, or replaces it once a newer path started.
+	// Returns false when nothing new arrived. Path may be partial, later polls extend it.
+	bool Poll(std::vector<glm::vec3>& outPath);
+
+	// Same for the ensemble spread, which only ever arrives complete
+	bool PollSpread(std::vector<std::vector<glm::vec3>>& outPaths);
+
+	inline static constexpr uint32_t POINTS_PER_CHUNK = 64;
+
+	// Parareal runs cover long horizons, so they get a bigger point budget than the regular sampler's
+	inline static constexpr uint32_t PARAREAL_MAX_POINTS = 8192;
+
+private:
+	struct PredictionRequest
+	{
+		BodyStore Bodies;
+		size_t TargetIdx = 0;
+		size_t ParentIdx = 0;
+		bool Relative = false;
+		uint32_t N = 0;
+		PredictionOptions Options;
+		uint64_t Generation = 0;
+	};
+
+	// Points the UI hasn't taken yet, Restart when they begin a new path instead of continuing the shown one
+	struct PredictionResult
+	{
+		std::vector<glm::vec3> Points;
+		bool Restart = false;
+	};
+
+	struct SpreadResult
+	{
+		std::vector<std::vector<glm::vec3>> Paths;
+	};
+
+	void Work();
+	void Publish(const std::vector<glm::vec3>& points, size_t fromPoint);
+	void Recycle(PredictionRequest* request);
+
+	std::atomic<PredictionRequest*> m_Pending = nullptr;
+	std::atomic<PredictionRequest*> m_Spare	  = nullptr;
+	std::atomic<PredictionResult*>  m_Ready	  = nullptr;
+	std::atomic<SpreadResult*>		m_ReadySpread = nullptr;
+
+	std::atomic<uint64_t> m_Generation = 0;
+	std::atomic<bool>	  m_WorkerActive = false;
+
+	JobHandle m_Job;
+};
\ No newline at end of file
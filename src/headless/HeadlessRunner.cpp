@@ -0,0 +1,341 @@
+#include "HeadlessRunner.hpp"
+#include "../Logger.hpp"
+#include "../JobSystem.hpp"
+#include "../random_utils/SceneFile.hpp"
+#include "../physics/SystemIntegrator.hpp"
+#include "../physics/SimClock.hpp"
+#include "../physics/Checkpoint.hpp"
+#include "../physics/TrajectoryFile.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+
+std::optional<HeadlessOptions> HeadlessRunner::ParseArguments(int argc, char** argv)
+{
+	HeadlessOptions options;
+
+	for (int i = 1; i < argc; i++)
+	{
+		const char* arg = argv[i];
+		bool hasValue = i + 1 < argc;
+
+		if (strcmp(arg, "--days") == 0 && hasValue)
+		{
+			options.Days = std::atof(argv[++i]);
+		}
+		else if (strcmp(arg, "--time-scale") == 0 && hasValue)
+		{
+			options.TimeScale = (float)std::atof(argv[++i]);
+		}
+		else if (strcmp(arg, "--threads") == 0 && hasValue)
+		{
+			options.Threads = (uint32_t)std::atoi(argv[++i]);
+		}
+		else if (strcmp(arg, "--eject") == 0 && hasValue)
+		{
+			options.EjectionRadius = (float)std::atof(argv[++i]);
+		}
+		else if (strcmp(arg, "--out") == 0 && hasValue)
+		{
+			options.OutputPath = argv[++i];
+		}
+		else if (strcmp(arg, "--sweep") == 0 && hasValue)
+		{
+			options.SweepPath = argv[++i];
+		}
+		else if (strcmp(arg, "--checkpoint") == 0 && hasValue)
+		{
+			options.CheckpointPath = argv[++i];
+		}
+		else if (strcmp(arg, "--checkpoint-interval") == 0 && hasValue)
+		{
+			options.CheckpointInterval = std::strtoull(argv[++i], nullptr, 10);
+		}
+		else if (strcmp(arg, "--record") == 0 && hasValue)
+		{
+			options.RecordPath = argv[++i];
+		}
+		else if (strcmp(arg, "--record-every") == 0 && hasValue)
+		{
+			options.RecordEvery = (uint32_t)std::max(std::atoi(argv[++i]), 1);
+		}
+		else if (strcmp(arg, "--record-error") == 0 && hasValue)
+		{
+			options.RecordError = (float)std::atof(argv[++i]);
+		}
+		else if (strcmp(arg, "--resume") == 0 && hasValue)
+		{
+			options.ResumePath = argv[++i];
+		}
+		else if (strcmp(arg, "--hierarchical") == 0)
+		{
+			options.Hierarchical = true;
+		}
+		else if (strcmp(arg, "--rails") == 0)
+		{
+			options.Rails = true;
+		}
+		else if (strcmp(arg, "--events") == 0)
+		{
+			options.Events = true;
+		}
+		else if (strcmp(arg, "--conservation") == 0)
+		{
+			options.Conservation = true;
+		}
+		else if (strcmp(arg, "--deterministic") == 0)
+		{
+			options.Deterministic = true;
+		}
+		else if (arg[0] != '-' && options.ScenePath.empty())
+		{
+			options.ScenePath = arg;
+		}
+		else
+		{
+			LOG_ERROR("Unknown argument {}.", arg);
+
+			return {};
+		}
+	}
+
+	if (options.ScenePath.empty() || options.Days <= 0.0 || options.TimeScale <= 0.0f)
+	{
+		return {};
+	}
+
+	return options;
+}
+
+void HeadlessRunner::PrintUsage()
+{
+	std::printf(
+		"Usage: SolarSystemSim-Headless <scene.sscene> [options]\n"
+		"  --days <d>          simulated duration, 365 by default\n"
+		"  --time-scale <s>    simulated time per step relative to the default one\n"
+		"  --threads <n>       threads to step with, one per core by default\n"
+		"  --hierarchical      integrate in sphere of influence coordinates\n"
+		"  --rails             put weakly perturbed bodies on Kepler orbits\n"
+		"  --events            log close approaches, periapses and SOI transitions\n"
+		"  --conservation      log energy and momentum drift\n"
+		"  --deterministic     same result on any thread count, logs the final state hash\n"
+		"  --eject <radius>    remove bodies escaping past radius\n"
+		"  --out <path>        write the final state to a scene file, or sweep records to <path>.csv and <path>.states\n"
+		"  --sweep <spec>      run every variant of the scene described by the sweep file\n"
+		"  --checkpoint <path> keep a checkpoint of the run at path, rewritten every checkpoint interval\n"
+		"  --checkpoint-interval <steps>  steps between checkpoints, 864000 by default\n"
+		"  --resume <path>     continue the run saved in a checkpoint of the same scene\n"
+		"  --record <path>     record a compressed trajectory of the run\n"
+		"  --record-every <n>  record every n-th step only\n"
+		"  --record-error <e>  biggest position error the recording may have, 0.001 by default\n");
+}
+
+bool HeadlessRunner::Run(const HeadlessOptions& options)
+{
+	// Scene file index of every body, bodies removed along the way drop out of it
+	BodyStore bodies;
+	std::vector<uint32_t> bodyIds;
+
+	std::optional<SceneFile> scene = SceneFile::Read(options.ScenePath, &bodies);
+	if (!scene.has_value())
+	{
+		return false;
+	}
+
+	// Checkpoints carry it, resuming checks them against the scene given this time
+	uint64_t sceneHash = bodies.Hash();
+	std::optional<Checkpoint> checkpoint;
+
+	if (!options.ResumePath.empty())
+	{
+		checkpoint = Checkpoint::Read(options.ResumePath);
+
+		if (!checkpoint.has_value())
+		{
+			return false;
+		}
+
+		// Ids index the scene's objects once the run ends, a checkpoint of some other scene would read past them
+		// or silently write its bodies over the wrong objects. Bodies only ever drop out, so the ids left are distinct and still in scene order.
+		const std::vector<uint32_t>& ids = checkpoint->BodyIds;
+		bool matches = checkpoint->SourceHash == sceneHash && ids.size() == checkpoint->Bodies.Size() && ids.size() <= scene->Objects.size();
+
+		for (size_t i = 0; matches && i < ids.size(); i++)
+		{
+			matches = ids[i] < scene->Objects.size() && (i == 0 || ids[i] > ids[i - 1]);
+		}
+
+		if (!matches)
+		{
+			LOG_ERROR("Checkpoint {} wasn't taken from a run of {}.", options.ResumePath, options.ScenePath);
+
+			return false;
+		}
+
+		if (checkpoint->Deterministic != SimClock::DETERMINISTIC)
+		{
+			LOG_ERROR("Checkpoint {} was taken {} deterministic mode, resume it the same way.", options.ResumePath,
+				checkpoint->Deterministic ? "in" : "outside of");
+
+			return false;
+		}
+	}
+
+	// Main thread helps out while waiting, so a single thread needs no workers at all
+	if (options.Threads != 1)
+	{
+		JobSystem::Init(options.Threads == 0 ? 0 : options.Threads - 1);
+	}
+
+	SystemIntegrator system;
+	uint64_t firstStep = 0;
+
+	if (checkpoint.has_value())
+	{
+		bodies = checkpoint->Bodies;
+		bodyIds = checkpoint->BodyIds;
+		firstStep = checkpoint->Step;
+
+		// Settings come along with the state, flags passed now would make the resumed run diverge
+		if (!checkpoint->Restore(system))
+		{
+			LOG_ERROR("Checkpoint {} doesn't match this build.", options.ResumePath);
+			JobSystem::Shutdown();
+
+			return false;
+		}
+
+		LOG_INFO("Resuming from step {} of {}.", firstStep, options.ResumePath);
+	}
+	else
+	{
+		bodyIds.resize(scene->Objects.size());
+
+		for (size_t i = 0; i < scene->Objects.size(); i++)
+		{
+			bodyIds[i] = (uint32_t)i;
+		}
+
+		SimClock::TPS_MULTIPLIER = options.TimeScale;
+		system.HierarchicalIntegration = options.Hierarchical;
+		system.TrackConservation = options.Conservation;
+		system.DetectEvents = options.Events;
+		system.GetRails().Enabled = options.Rails;
+		system.GetEjection().Enabled = options.EjectionRadius > 0.0f;
+		system.GetEjection().Radius = options.EjectionRadius;
+		system.GetEjection().Mode = EjectionPolicy::Action::Remove;
+	}
+
+	system.GetConservation().LogEnabled = system.TrackConservation;
+	system.GetEvents().LogEnabled = system.DetectEvents;
+
+	CheckpointWriter checkpoints;
+	checkpoints.Interval = options.CheckpointPath.empty() ? 0 : options.CheckpointInterval;
+
+	float timeScale = SimClock::TPS_MULTIPLIER;
+	double stepDuration = (double)SimClock::TPS_STEP * timeScale;
+	uint64_t stepCount = (uint64_t)std::ceil(options.Days / stepDuration);
+	uint64_t progressInterval = std::max<uint64_t>(stepCount / 10, 1);
+
+	TrajectoryWriter recording;
+
+	if (!options.RecordPath.empty())
+	{
+		TrajectoryCodec::Spec spec;
+		spec.PositionError = options.RecordError;
+
+		if (recording.Open(options.RecordPath, spec))
+		{
+			recording.Append(bodyIds, bodies.Positions, bodies.Velocities, firstStep * stepDuration);
+		}
+	}
+
+	LOG_INFO("Integrating \"{}\", {} bodies for {} days in {} steps.", scene->Name, bodies.Size(), options.Days, stepCount);
+
+	auto start = std::chrono::steady_clock::now();
+
+	for (uint64_t step = firstStep; step < stepCount; step++)
+	{
+		system.Step(bodies, timeScale);
+
+		// Removed indices are ascending, erasing from the back keeps the earlier ones valid
+		const std::vector<uint32_t>& removed = system.GetRemovedBodies();
+
+		for (auto it = removed.rbegin(); it != removed.rend(); it++)
+		{
+			bodyIds.erase(bodyIds.begin() + *it);
+		}
+
+		if ((step + 1) % options.RecordEvery == 0)
+		{
+			recording.Append(bodyIds, bodies.Positions, bodies.Velocities, (step + 1) * stepDuration);
+		}
+
+		if ((step + 1) % progressInterval == 0)
+		{
+			LOG_INFO("{:.0f}% done, {} bodies left.", 100.0 * (step + 1) / stepCount, bodies.Size());
+		}
+
+		if (checkpoints.Interval > 0 && (step + 1) % checkpoints.Interval == 0)
+		{
+			Checkpoint state = Checkpoint::Capture(bodies, bodyIds, system, step + 1);
+			state.SourceHash = sceneHash;
+			checkpoints.WriteAsync(std::move(state), options.CheckpointPath);
+		}
+	}
+
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	LOG_INFO("Finished in {:.3f}s, {:.0f} steps per second.", seconds, (stepCount - std::min(firstStep, stepCount)) / std::max(seconds, 1e-9));
+
+	if (system.TrackConservation)
+	{
+		LOG_INFO("Relative energy drift {:.3e}, momentum drift {:.3e}.", system.GetConservation().GetEnergyDrift(), system.GetConservation().GetMomentumDrift());
+	}
+
+	if (SimClock::DETERMINISTIC)
+	{
+		LOG_INFO("Final state hash {:016x}.", bodies.Hash());
+	}
+
+	if (recording.IsOpen())
+	{
+		recording.Close();
+		LOG_INFO("Recorded {} frames to {}, {:.1f}x smaller than plain floats.", recording.GetFrameCount(), options.RecordPath,
+			(double)recording.GetRawBytes() / std::max<uint64_t>(recording.GetWrittenBytes(), 1));
+	}
+
+	checkpoints.Wait();
+	JobSystem::Shutdown();
+
+	if (options.OutputPath.empty())
+	{
+		return true;
+	}
+
+	std::vector<SceneFile::ObjectRecord> remaining;
+
+	for (size_t i = 0; i < bodyIds.size(); i++)
+	{
+		SceneFile::ObjectRecord& object = remaining.emplace_back(scene->Objects[bodyIds[i]]);
+		object.ObjectTransform.Position = bodies.Positions[i];
+		object.ObjectPhysics.LinearVelocity = bodies.Velocities[i];
+	}
+
+	scene->Objects = std::move(remaining);
+
+	if (!scene->Write(options.OutputPath))
+	{
+		LOG_ERROR("Final state could not be written to {}.", options.OutputPath);
+
+		return false;
+	}
+
+	LOG_INFO("Final state written to {}.", options.OutputPath);
+
+	return true;
+}
\ No newline at end of file
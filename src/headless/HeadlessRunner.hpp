@@ -0,0 +1,62 @@
+#pragma once
+
+#include <string>
+#include <optional>
+#include <cstdint>
+
+struct HeadlessOptions
+{
+	std::string ScenePath;
+
+	// Final state gets written here as a scene file, nothing gets written when it's empty.
+	// Sweeps write their records next to this path instead.
+	std::string OutputPath;
+
+	// Sweep specification, runs a single simulation when it's empty
+	std::string SweepPath;
+
+	// Checkpoints get written here every CheckpointInterval steps, none when it's empty
+	std::string CheckpointPath;
+	uint64_t CheckpointInterval = 864000;
+
+	// Compressed trajectory of the run gets recorded here, every RecordEvery-th step and accurate to RecordError
+	std::string RecordPath;
+	uint32_t RecordEvery = 1;
+	float RecordError = 1e-3f;
+
+	// Checkpoint to continue from, the run then ends at the same point it would have without the interruption
+	std::string ResumePath;
+
+	// Simulated duration, a day is a time unit at time scale 1.0
+	double Days = 365.0;
+	float TimeScale = 1.0f;
+
+	// Threads stepping the simulation, 0 picks one per core
+	uint32_t Threads = 0;
+
+	bool Hierarchical = false;
+	bool Rails = false;
+	bool Events = false;
+	bool Conservation = false;
+
+	// Results only depend on the scene and the options, the final state hash gets logged to compare runs by
+	bool Deterministic = false;
+
+	// Bodies escaping past it get removed, 0 keeps every body
+	float EjectionRadius = 0.0f;
+};
+
+// Integrates a scene file for a given duration as fast as the machine allows, no window or GL context involved.
+// Steps go through the same SystemIntegrator the windowed simulation uses.
+class HeadlessRunner
+{
+public:
+	static std::optional<HeadlessOptions> ParseArguments(int argc, char** argv);
+	static void PrintUsage();
+
+	// Returns false when the scene couldn't be loaded or the result couldn't be saved
+	static bool Run(const HeadlessOptions& options);
+
+private:
+	HeadlessRunner() = default;
+};
\ No newline at end of file
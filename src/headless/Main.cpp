@@ -0,0 +1,24 @@
+#include "HeadlessRunner.hpp"
+#include "SweepRunner.hpp"
+#include "../Logger.hpp"
+#include "../physics/SimClock.hpp"
+
+int main(int argc, char** argv)
+{
+	Logger::Init();
+
+	std::optional<HeadlessOptions> options = HeadlessRunner::ParseArguments(argc, argv);
+
+	if (!options.has_value())
+	{
+		HeadlessRunner::PrintUsage();
+
+		return 1;
+	}
+
+	SimClock::DETERMINISTIC = options->Deterministic;
+
+	bool succeeded = options->SweepPath.empty() ? HeadlessRunner::Run(options.value()) : SweepRunner::Run(options.value());
+
+	return succeeded ? 0 : 1;
+}
\ No newline at end of file
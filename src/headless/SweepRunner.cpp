@@ -0,0 +1,226 @@
+#include "SweepRunner.hpp"
+#include "../Logger.hpp"
+#include "../JobSystem.hpp"
+#include "../physics/SystemIntegrator.hpp"
+#include "../physics/SimClock.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+
+bool SweepRunner::Run(const HeadlessOptions& options)
+{
+	if (options.OutputPath.empty())
+	{
+		LOG_ERROR("Sweeps need an output path for their records.");
+
+		return false;
+	}
+
+	BodyStore baseBodies;
+	std::optional<SceneFile> base = SceneFile::Read(options.ScenePath, &baseBodies);
+	std::optional<SweepSpec> spec = SweepSpec::Read(options.SweepPath);
+
+	if (!base.has_value() || !spec.has_value())
+	{
+		return false;
+	}
+
+	if (options.Threads != 1)
+	{
+		JobSystem::Init(options.Threads == 0 ? 0 : options.Threads - 1);
+	}
+
+	LOG_INFO("Sweeping \"{}\" over {} runs of {} days on {} threads.", base->Name, spec->Runs, options.Days, JobSystem::GetWorkerCount() + 1);
+
+	// Every run writes its own record only, so they need no locking
+	std::vector<RunRecord> records(spec->Runs);
+	std::vector<JobHandle> jobs;
+	std::atomic<uint32_t> finished = 0;
+	uint32_t progressInterval = std::max(spec->Runs / 10, 1u);
+
+	jobs.reserve(spec->Runs);
+	auto start = std::chrono::steady_clock::now();
+
+	for (uint32_t run = 0; run < spec->Runs; run++)
+	{
+		jobs.push_back(JobSystem::Submit([&, run]()
+			{
+				RunOne(base.value(), baseBodies, spec.value(), options, run, records[run]);
+
+				uint32_t done = ++finished;
+
+				if (done % progressInterval == 0)
+				{
+					LOG_INFO("{}/{} runs done.", done, spec->Runs);
+				}
+			}));
+	}
+
+	for (const JobHandle& job : jobs)
+	{
+		JobSystem::Wait(job);
+	}
+
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	LOG_INFO("Sweep finished in {:.3f}s.", seconds);
+
+	JobSystem::Shutdown();
+
+	bool written = WriteSummary(options.OutputPath + ".csv", spec.value(), records)
+		&& WriteStates(options.OutputPath + ".states", records);
+
+	if (!written)
+	{
+		LOG_ERROR("Sweep records could not be written to {}.", options.OutputPath);
+
+		return false;
+	}
+
+	LOG_INFO("Sweep records written to {}.csv and {}.states.", options.OutputPath, options.OutputPath);
+
+	return true;
+}
+
+void SweepRunner::RunOne(const SceneFile& base, const BodyStore& baseBodies, const SweepSpec& spec, const HeadlessOptions& options, uint32_t runIdx, RunRecord& outRecord)
+{
+	auto start = std::chrono::steady_clock::now();
+
+	BodyStore bodies = baseBodies;
+	SystemIntegrator system;
+
+	outRecord.Parameters = spec.Sample(runIdx);
+
+	for (size_t p = 0; p < spec.Parameters.size(); p++)
+	{
+		const SweepSpec::Parameter& param = spec.Parameters[p];
+		float value = (float)outRecord.Parameters[p];
+
+		// Every run integrates with its own G, it isn't a per-body parameter
+		if (param.ParameterKind == SweepSpec::Parameter::Kind::GMultiplier)
+		{
+			system.GMultiplier = value;
+
+			continue;
+		}
+
+		for (size_t i = 0; i < base.Objects.size(); i++)
+		{
+			bool targeted = param.Target.empty() || param.Target == base.Objects[i].Tag;
+
+			switch (param.ParameterKind)
+			{
+			case SweepSpec::Parameter::Kind::Mass:
+				bodies.Masses[i] *= targeted ? value : 1.0f;
+				break;
+
+			case SweepSpec::Parameter::Kind::Velocity:
+				bodies.Velocities[i] *= targeted ? value : 1.0f;
+				break;
+
+			default:
+				break;
+			}
+		}
+	}
+
+	system.HierarchicalIntegration = options.Hierarchical;
+	system.TrackConservation = true;
+	system.DetectEvents = options.Events;
+	system.GetRails().Enabled = options.Rails;
+	system.GetEjection().Enabled = options.EjectionRadius > 0.0f;
+	system.GetEjection().Radius = options.EjectionRadius;
+
+	// Removing bodies would leave every run with different ones, ballistic keeps records comparable
+	system.GetEjection().Mode = EjectionPolicy::Action::Ballistic;
+
+	double stepDuration = (double)SimClock::TPS_STEP * options.TimeScale;
+	uint64_t stepCount = (uint64_t)std::ceil(options.Days / stepDuration);
+
+	for (uint64_t step = 0; step < stepCount; step++)
+	{
+		system.Step(bodies, options.TimeScale);
+	}
+
+	const ConservationMonitor& conservation = system.GetConservation();
+	const EventDetector& events = system.GetEvents();
+
+	outRecord.Positions = bodies.Positions;
+	outRecord.Velocities = bodies.Velocities;
+	outRecord.EnergyDrift = conservation.GetEnergyDrift();
+	outRecord.MomentumDrift = conservation.GetMomentumDrift();
+	outRecord.AngularMomentumDrift = conservation.GetAngularMomentumDrift();
+	outRecord.EventCounts[0] = events.GetCount(SimEvent::Type::CloseApproach);
+	outRecord.EventCounts[1] = events.GetCount(SimEvent::Type::Periapsis);
+	outRecord.EventCounts[2] = events.GetCount(SimEvent::Type::SoiEnter);
+	outRecord.EventCounts[3] = events.GetCount(SimEvent::Type::SoiExit);
+	outRecord.Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+bool SweepRunner::WriteSummary(const std::string& path, const SweepSpec& spec, const std::vector<RunRecord>& records)
+{
+	std::ofstream file(path);
+	if (!file.good())
+	{
+		return false;
+	}
+
+	file << "run";
+
+	for (size_t p = 0; p < spec.Parameters.size(); p++)
+	{
+		file << ',' << spec.GetParameterName(p);
+	}
+
+	file << ",energy_drift,momentum_drift,angular_momentum_drift,close_approaches,periapses,soi_enters,soi_exits,seconds\n";
+	file.precision(9);
+
+	for (size_t run = 0; run < records.size(); run++)
+	{
+		const RunRecord& record = records[run];
+
+		file << run;
+
+		for (double value : record.Parameters)
+		{
+			file << ',' << value;
+		}
+
+		file << ',' << record.EnergyDrift << ',' << record.MomentumDrift << ',' << record.AngularMomentumDrift;
+
+		for (uint64_t count : record.EventCounts)
+		{
+			file << ',' << count;
+		}
+
+		file << ',' << record.Seconds << '\n';
+	}
+
+	return file.good();
+}
+
+bool SweepRunner::WriteStates(const std::string& path, const std::vector<RunRecord>& records)
+{
+	std::ofstream file(path, std::ios::out | std::ios::binary);
+	if (!file.good())
+	{
+		return false;
+	}
+
+	// Header, then per run its body count, positions and velocities
+	int32_t runCount = records.size();
+	file.write("SSSSWEEP", 9);
+	file.write((char*)&runCount, sizeof(int32_t));
+
+	for (const RunRecord& record : records)
+	{
+		int32_t bodyCount = record.Positions.size();
+		file.write((char*)&bodyCount, sizeof(int32_t));
+		file.write((char*)record.Positions.data(),	bodyCount * sizeof(glm::vec3));
+		file.write((char*)record.Velocities.data(), bodyCount * sizeof(glm::vec3));
+	}
+
+	return file.good();
+}
\ No newline at end of file
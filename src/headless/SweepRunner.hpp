@@ -0,0 +1,40 @@
+#pragma once
+
+#include "HeadlessRunner.hpp"
+#include "SweepSpec.hpp"
+#include "../random_utils/SceneFile.hpp"
+
+#include <glm/glm.hpp>
+
+#include <vector>
+#include <cstdint>
+
+// Runs every variant of a sweep as an independent job, as many at once as there are workers.
+// Results land in two files next to each other: <out>.csv with one summary line per run
+// and <out>.states, the final positions and velocities of every run in binary.
+class SweepRunner
+{
+public:
+	// Returns false when the sweep couldn't be read or the results couldn't be written
+	static bool Run(const HeadlessOptions& options);
+
+private:
+	struct RunRecord
+	{
+		std::vector<double> Parameters;
+		std::vector<glm::vec3> Positions;
+		std::vector<glm::vec3> Velocities;
+
+		double EnergyDrift = 0.0;
+		double MomentumDrift = 0.0;
+		double AngularMomentumDrift = 0.0;
+		uint64_t EventCounts[4]{};
+		double Seconds = 0.0;
+	};
+
+	static void RunOne(const SceneFile& base, const BodyStore& baseBodies, const SweepSpec& spec, const HeadlessOptions& options, uint32_t runIdx, RunRecord& outRecord);
+	static bool WriteSummary(const std::string& path, const SweepSpec& spec, const std::vector<RunRecord>& records);
+	static bool WriteStates(const std::string& path, const std::vector<RunRecord>& records);
+
+	SweepRunner() = default;
+};
\ No newline at end of file
@@ -0,0 +1,144 @@
+#include "SweepSpec.hpp"
+#include "../Logger.hpp"
+
+#include <fstream>
+#include <sstream>
+#include <random>
+
+namespace
+{
+	std::string Trim(const std::string& str)
+	{
+		size_t begin = str.find_first_not_of(" \t\r");
+		size_t end = str.find_last_not_of(" \t\r");
+
+		return begin == std::string::npos ? std::string() : str.substr(begin, end - begin + 1);
+	}
+}
+
+std::optional<SweepSpec> SweepSpec::Read(const std::string& path)
+{
+	std::ifstream file(path);
+	if (!file.good())
+	{
+		LOG_ERROR("Sweep file {} could not be opened.", path);
+
+		return {};
+	}
+
+	SweepSpec spec;
+	std::string line;
+	uint32_t lineIdx = 0;
+
+	while (std::getline(file, line))
+	{
+		lineIdx++;
+		line = Trim(line.substr(0, line.find('#')));
+
+		if (line.empty())
+		{
+			continue;
+		}
+
+		std::istringstream stream(line);
+		std::string directive;
+		stream >> directive;
+
+		bool valid = true;
+
+		if (directive == "runs")
+		{
+			// Read signed, an unsigned read would take "-1" for the biggest count there is
+			int64_t runs = 0;
+			valid = (bool)(stream >> runs) && runs > 0 && runs <= MAX_RUNS;
+			spec.Runs = valid ? (uint32_t)runs : spec.Runs;
+		}
+		else if (directive == "seed")
+		{
+			valid = (bool)(stream >> spec.Seed);
+		}
+		else if (directive == "mode")
+		{
+			std::string mode;
+			stream >> mode;
+
+			valid = mode == "random" || mode == "linear";
+			spec.SweepMode = mode == "linear" ? Mode::Linear : Mode::Random;
+		}
+		else if (directive == "mass" || directive == "velocity" || directive == "g")
+		{
+			Parameter& param = spec.Parameters.emplace_back();
+			param.ParameterKind = directive == "mass" ? Parameter::Kind::Mass
+				: directive == "velocity" ? Parameter::Kind::Velocity : Parameter::Kind::GMultiplier;
+
+			// Tags may contain spaces, so the range gets taken off the end and the target is whatever's left
+			size_t toStart = line.find_last_of(" \t");
+			size_t fromStart = toStart == std::string::npos ? std::string::npos
+				: line.find_last_of(" \t", line.find_last_not_of(" \t", toStart));
+
+			if (fromStart == std::string::npos)
+			{
+				valid = false;
+			}
+			else
+			{
+				std::istringstream range(line.substr(fromStart));
+				valid = (bool)(range >> param.From >> param.To);
+			}
+
+			if (valid && param.ParameterKind != Parameter::Kind::GMultiplier)
+			{
+				param.Target = Trim(line.substr(directive.length(), fromStart - directive.length()));
+				valid = !param.Target.empty();
+				param.Target = param.Target == "*" ? std::string() : param.Target;
+			}
+		}
+		else
+		{
+			valid = false;
+		}
+
+		if (!valid)
+		{
+			LOG_ERROR("Sweep file {}, line {}: can't make sense of \"{}\".", path, lineIdx, line);
+
+			return {};
+		}
+	}
+
+	return spec;
+}
+
+std::vector<double> SweepSpec::Sample(uint32_t runIdx) const
+{
+	std::vector<double> values(Parameters.size());
+
+	// Seeded by the run itself, so values don't depend on which runs came before or on which thread
+	std::mt19937_64 engine(Seed ^ (0x9E3779B97F4A7C15ull * (runIdx + 1)));
+
+	for (size_t i = 0; i < Parameters.size(); i++)
+	{
+		const Parameter& param = Parameters[i];
+		double t = SweepMode == Mode::Linear
+			? (Runs > 1 ? (double)runIdx / (Runs - 1) : 0.0)
+			: std::uniform_real_distribution<double>(0.0, 1.0)(engine);
+
+		values[i] = param.From + (param.To - param.From) * t;
+	}
+
+	return values;
+}
+
+std::string SweepSpec::GetParameterName(size_t paramIdx) const
+{
+	const Parameter& param = Parameters[paramIdx];
+
+	switch (param.ParameterKind)
+	{
+	case Parameter::Kind::Mass:		return "mass:" + (param.Target.empty() ? "*" : param.Target);
+	case Parameter::Kind::Velocity: return "velocity:" + (param.Target.empty() ? "*" : param.Target);
+	case Parameter::Kind::GMultiplier:	return "g";
+	}
+
+	return "?";
+}
\ No newline at end of file
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <string>
+#include <optional>
+#include <vector>
+#include <cstdint>
+
+// Parameters varied across the runs of a sweep, read from a plain text file, one directive per line:
+//   runs <count>
+//   seed <number>
+//   mode random | linear
+//   mass <tag or *> <from> <to>
+//   velocity <tag or *> <from> <to>
+//   g <from> <to>
+// Mass and velocity values multiply the scene's own, '#' starts a comment.
+struct SweepSpec
+{
+	enum class Mode
+	{
+		// Every parameter drawn independently for every run
+		Random,
+
+		// Every parameter moves from its start to its end value over the runs, all of them together
+		Linear
+	};
+
+	struct Parameter
+	{
+		enum class Kind
+		{
+			Mass,
+			Velocity,
+			GMultiplier
+		};
+
+		Kind ParameterKind = Kind::Mass;
+
+		// Tag of the affected object, empty for all of them
+		std::string Target;
+
+		double From = 1.0;
+		double To = 1.0;
+	};
+
+	uint32_t Runs = 1;
+	uint64_t Seed = 0;
+	Mode SweepMode = Mode::Random;
+	std::vector<Parameter> Parameters;
+
+	// Every run keeps a record in memory until the sweep ends, more than this is surely a typo
+	inline static constexpr uint32_t MAX_RUNS = 1000000;
+
+	static std::optional<SweepSpec> Read(const std::string& path);
+
+	// Values of every parameter for the run, the same run always gets the same values
+	std::vector<double> Sample(uint32_t runIdx) const;
+
+	// Column name of the parameter in the summary records
+	std::string GetParameterName(size_t paramIdx) const;
+};
\ No newline at end of file
@@ -70,6 +70,7 @@ void EditorLayer::OnInput()
 void EditorLayer::OnUpdate(float ts)
 {
 	m_Scene->OnUpdate(ts);
+	m_Autosaver.OnUpdate(*m_Scene, ts);
 }
 
 void EditorLayer::OnTick()
@@ -121,7 +122,7 @@ void EditorLayer::RenderScenePanel()
 
 	if (ImGui::Button("Save scene"))
 	{
-		SceneSerializer::SaveScene(*m_Scene);
+		m_Autosaver.Save(*m_Scene, SceneSerializer::GetSavePath(m_Scene->m_SceneName));
 	}
 
 	ImGui::SameLine();
@@ -162,6 +163,7 @@ void EditorLayer::RenderScenePanel()
 		ImGuiFileDialog::Instance()->Close();
 	}
 
+	ImGui::Checkbox("Autosave", &m_Autosaver.Enabled);
 	ImGui::NewLine();
 
 	ImVec2 avSpace = ImGui::GetContentRegionAvail();
@@ -291,12 +293,14 @@ void EditorLayer::RenderTopbar()
 	ImGui::SetNextWindowSize({ windowSpec.Width * 0.6f, m_TopbarHeight });
 	
 	ImGui::Begin("Topbar", nullptr, ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoCollapse | ImGuiWindowFlags_NoTitleBar);
-	ImGui::Columns(5);
+	ImGui::Columns(7);
 	ImGui::SetColumnWidth(0, 72.0f);
 	ImGui::SetColumnWidth(1, 96.0f);
 	ImGui::SetColumnWidth(2, 144.0f);
 	ImGui::SetColumnWidth(3, 86.0f);
 	ImGui::SetColumnWidth(4, 86.0f);
+	ImGui::SetColumnWidth(5, 86.0f);
+	ImGui::SetColumnWidth(6, 86.0f);
 
 	Camera& editorCam = m_Scene->m_Camera;
 	Planet* selectedPlanet = m_Scene->m_SelectedPlanet;
@@ -390,6 +394,12 @@ void EditorLayer::RenderTopbar()
 
 	ImGui::NextColumn();
 	ImGui::Checkbox("Skybox", &m_Scene->m_RenderSkybox);
+
+	ImGui::NextColumn();
+	ImGui::Checkbox("Orbits", &m_Scene->m_RenderOrbits);
+
+	ImGui::NextColumn();
+	ImGui::Checkbox("Spread", &m_Scene->m_RenderSpread);
 	
 	ImGui::Columns(1);
 	ImGui::End();
@@ -2,6 +2,7 @@
 
 #include "Layer.hpp"
 #include "../scenes/EditorScene.hpp"
+#include "../random_utils/SceneAutosaver.hpp"
 
 #include <memory>
 
@@ -27,6 +28,7 @@ private:
 	void RenderEntityData();
 
 	std::unique_ptr<EditorScene> m_Scene;
+	SceneAutosaver m_Autosaver;
 
 	int32_t m_GizmoMode = -1; // None
 	int32_t m_GizmoCoords = 1; // World
@@ -1,8 +1,15 @@
 #pragma once
 
 #include "Layer.hpp"
+#include "../FrameGovernor.hpp"
+#include "../physics/BodyStore.hpp"
+#include "../physics/TrajectoryRecorder.hpp"
+#include "../physics/TrajectoryFile.hpp"
+#include "../physics/Timeline.hpp"
 
 #include <memory>
+#include <string>
+#include <vector>
 
 class EditorScene;
 
@@ -22,13 +29,47 @@ public:
 private:
 	void RenderControlBar();
 	void RenderViewport();
+	void RenderConservationPanel();
+	void RenderEventsPanel();
+	void RenderTimeline();
+
+	void StartRecording();
+	void ScrubTo(double time);
+	void ShowFrame(const TrajectoryRecorder::Frame& frame);
+	void LeaveReplay();
+	void ExportRecording();
+	void SetPlayback(bool enabled);
+	std::string GetExportPath() const;
 
 	std::unique_ptr<EditorScene> m_Scene;
+	FrameGovernor m_Governor;
+
+	// Recorded frames refer to bodies by their index in the scene at start, this maps the remaining ones to it
+	std::vector<uint32_t> m_BodyIds;
+	TrajectoryRecorder m_Recorder;
+	TrajectoryRecorder::Frame m_ReplayFrame;
+
+	// Always on, covers the whole run in memory where the recording only keeps its newest frames
+	Timeline m_Timeline;
+
+	// Export reads the recorder on a worker, no frames get recorded until it's done
+	JobHandle m_ExportJob;
 
-	float m_SimulationTimePassed = 0.0f;
-	float m_RealTimePassed		 = 0.0f;
+	// Exported recording, scrubbed instead of the run's own history while it's open
+	TrajectoryReader m_Playback;
+
+	// Where the simulation was when scrubbing started, it continues from there and not from the replayed frame
+	BodyStore m_LiveBodies;
+	double m_ReplayTime = 0.0;
+	bool m_IsReplaying = false;
+	bool m_IsRecording = false;
+
+	float m_RealTimePassed = 0.0f;
 	
 	float m_ControlBarHeight = 40.0f;
 	bool m_IsRunning = false;
 	bool m_IsViewportFocused = true;
+
+	// Disk space the recording may take, the oldest frames get overwritten past it
+	inline static constexpr uint64_t RECORDING_BUDGET = 256ull * 1024 * 1024;
 };
\ No newline at end of file
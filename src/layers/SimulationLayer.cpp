@@ -1,14 +1,20 @@
 #include "../scenes/states/EditorSceneStates.hpp"
 #include "SimulationLayer.hpp"
 #include "../Simulator.hpp"
+#include "../scenes/PlanetBodies.hpp"
 #include "../Application.hpp"
 #include "../scenes/EditorScene.hpp"
 #include "../TextureManager.hpp"
 #include "../objects/Sun.hpp"
+#include "../Logger.hpp"
 
 #include <imgui/imgui.h>
 #include <glm/gtc/type_ptr.hpp>
 
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+
 SimulationLayer::SimulationLayer(std::unique_ptr<EditorScene>& scene)
 {
 	WindowSpec spec = Application::GetInstance()->GetWindowSpec();
@@ -20,10 +26,27 @@ SimulationLayer::SimulationLayer(std::unique_ptr<EditorScene>& scene)
 	m_Scene = std::make_unique<EditorScene>(*scene);
 	m_Scene->OnEvent(dummyEv);
 	m_Scene->SetViewportOffset({ 0.0f, m_ControlBarHeight });
+
+	m_BodyIds.resize(m_Scene->m_Planets.size());
+
+	for (uint32_t i = 0; i < (uint32_t)m_BodyIds.size(); i++)
+	{
+		m_BodyIds[i] = i;
+	}
+
+	BodyStore bodies;
+	PlanetBodies::TakeSnapshot(m_Scene->m_Planets, bodies);
+	m_Timeline.Start(bodies, m_BodyIds, m_Scene->m_System);
+
+	if (m_IsRecording)
+	{
+		StartRecording();
+	}
 }
 
 SimulationLayer::~SimulationLayer()
 {
+	JobSystem::Wait(m_ExportJob);
 }
 
 void SimulationLayer::OnEvent(Event& ev)
@@ -62,8 +85,13 @@ void SimulationLayer::OnUpdate(float ts)
 {
 	if (m_IsRunning)
 	{
-		m_SimulationTimePassed += ts * Application::TPS_MULTIPLIER;
 		m_RealTimePassed += ts;
+		m_Governor.OnFrame(ts);
+	}
+
+	if (m_IsReplaying && m_Timeline.Poll(m_ReplayFrame))
+	{
+		ShowFrame(m_ReplayFrame);
 	}
 		
 	m_Scene->OnUpdate(ts);
@@ -71,9 +99,40 @@ void SimulationLayer::OnUpdate(float ts)
 
 void SimulationLayer::OnTick()
 {
-	if (m_IsRunning)
+	if (!m_IsRunning)
+	{
+		return;
+	}
+
+	FrameGovernor::StepPlan plan = m_Governor.Plan(SimClock::TPS_MULTIPLIER);
+	auto start = std::chrono::steady_clock::now();
+
+	for (uint32_t i = 0; i < plan.Substeps; i++)
+	{
+		m_Scene->StepSimulation(plan.TimeScale);
+
+		// Removed indices are ascending, erasing from the back keeps the earlier ones valid
+		const std::vector<uint32_t>& removed = m_Scene->m_System.GetRemovedBodies();
+
+		for (auto it = removed.rbegin(); it != removed.rend(); it++)
+		{
+			m_BodyIds.erase(m_BodyIds.begin() + *it);
+		}
+
+		m_Timeline.Record(m_Scene->m_Bodies, m_BodyIds, m_Scene->m_System, plan.TimeScale);
+	}
+
+	float costMs = std::chrono::duration<float>(std::chrono::steady_clock::now() - start).count() * 1000.0f;
+	float simulatedTime = Application::TPS_STEP * plan.TimeScale * plan.Substeps;
+
+	m_Governor.OnTickFinished(costMs, plan.Substeps, simulatedTime);
+
+	// Scene's snapshot already holds the state every planet just got, it's copied straight into the recording.
+	// Timeline sums the time in doubles, a float total would stop telling frames apart after a few years.
+	// New frames would overwrite the oldest ones under a running export.
+	if (JobSystem::IsDone(m_ExportJob))
 	{
-		m_Scene->OnTick();
+		m_Recorder.Record(m_Scene->m_Bodies, m_BodyIds, m_Timeline.GetEndTime());
 	}
 }
 
@@ -86,6 +145,16 @@ void SimulationLayer::OnImGuiRender()
 		m_Scene->m_SelectedPlanet->OnSimDataRender();
 	}
 
+	if (m_Scene->m_System.TrackConservation)
+	{
+		RenderConservationPanel();
+	}
+
+	if (m_Scene->m_System.DetectEvents)
+	{
+		RenderEventsPanel();
+	}
+
 	RenderControlBar();
 }
 
@@ -104,6 +173,11 @@ void SimulationLayer::RenderControlBar()
 	if (ImGui::ImageButton((ImTextureID)TextureManager::GetAtlasTextureID(), { 16.0f, 16.0f },
 		{ playIcon.UV.x, playIcon.UV.y }, { playIcon.UV.x + playIcon.Size.x, playIcon.UV.y + playIcon.Size.y }))
 	{
+		if (m_IsReplaying)
+		{
+			LeaveReplay();
+		}
+
 		m_IsRunning = true;
 	}
 	ImGui::PopID();
@@ -117,6 +191,7 @@ void SimulationLayer::RenderControlBar()
 		{ pauseIcon.UV.x, pauseIcon.UV.y }, { pauseIcon.UV.x + pauseIcon.Size.x, pauseIcon.UV.y + pauseIcon.Size.y }))
 	{
 		m_IsRunning = false;
+		m_Governor.Reset();
 	}
 	ImGui::PopID();
 	ImGui::SameLine();
@@ -154,7 +229,90 @@ void SimulationLayer::RenderControlBar()
 		ImGui::SetNextWindowSize({ 512.0f, 312.0f }, ImGuiCond_FirstUseEver);
 		ImGui::Begin("Simulation settings");
 		ImGui::PrettyDragFloat("G Constant Multiplier", &SimPhysics::G_CONSTANT_MULTIPLIER, 0.0f, 0.0f, 200.0f);
-		ImGui::PrettyDragFloat("Time scale (1.0 = 1 day)", &Application::TPS_MULTIPLIER, 0.0f, 365.0f, 200.0f);
+		ImGui::PrettyDragFloat("Time scale (1.0 = 1 day)", &SimClock::TPS_MULTIPLIER, 0.0f, 365.0f, 200.0f);
+
+		ImGui::NewLine();
+		ImGui::Checkbox("Frame budget governor", &m_Governor.Enabled);
+
+		if (m_Governor.Enabled)
+		{
+			ImGui::PrettyDragFloat("Frame budget [ms]", &m_Governor.FrameBudgetMs, 1.0f, 100.0f, 200.0f);
+			ImGui::PrettyDragFloat("Max step time scale", &m_Governor.MaxStepTimeScale, 0.01f, 100.0f, 200.0f);
+		}
+
+		ImGui::Checkbox("Deterministic mode", &SimClock::DETERMINISTIC);
+
+		if (ImGui::Checkbox("Record trajectory", &m_IsRecording))
+		{
+			if (m_IsRecording)
+			{
+				StartRecording();
+			}
+			else
+			{
+				JobSystem::Wait(m_ExportJob);
+				m_Recorder.Close();
+			}
+		}
+
+		if (m_IsRecording)
+		{
+			int32_t decimation = (int32_t)m_Recorder.Decimation;
+
+			if (ImGui::DragInt("Record every n-th tick", &decimation, 1.0f, 1, SimClock::TPS))
+			{
+				m_Recorder.Decimation = (uint32_t)std::max(decimation, 1);
+			}
+
+			if (JobSystem::IsDone(m_ExportJob) && ImGui::Button("Export compressed recording"))
+			{
+				ExportRecording();
+			}
+		}
+
+		bool playback = m_Playback.GetFrameCount() > 0;
+
+		if (JobSystem::IsDone(m_ExportJob) && ImGui::Checkbox("Scrub exported recording", &playback))
+		{
+			SetPlayback(playback);
+		}
+
+		SystemIntegrator& system = m_Scene->m_System;
+
+		ImGui::Checkbox("Hierarchical integration", &system.HierarchicalIntegration);
+		ImGui::Checkbox("Conservation diagnostics", &system.TrackConservation);
+		ImGui::Checkbox("Event detection", &system.DetectEvents);
+
+		if (system.DetectEvents)
+		{
+			ImGui::PrettyDragFloat("Close approach distance", &system.GetEvents().CloseApproachDistance, 0.0f, 100.0f, 200.0f);
+
+			if (ImGui::IsItemHovered())
+			{
+				ImGui::SetTooltip("Bodies are points to the detector, there are no collisions, only approaches closer than this");
+			}
+		}
+
+		ImGui::Checkbox("Kepler on-rails", &system.GetRails().Enabled);
+
+		if (system.GetRails().Enabled)
+		{
+			ImGui::PrettyDragFloat("On-rails perturbation threshold", &system.GetRails().Threshold, 0.0f, 0.1f, 200.0f);
+		}
+
+		ImGui::Checkbox("Escaping body deactivation", &system.GetEjection().Enabled);
+
+		if (system.GetEjection().Enabled)
+		{
+			bool remove = system.GetEjection().Mode == EjectionPolicy::Action::Remove;
+
+			ImGui::PrettyDragFloat("Deactivation radius", &system.GetEjection().Radius, 0.0f, 100000.0f, 200.0f);
+
+			if (ImGui::Checkbox("Remove escaped bodies", &remove))
+			{
+				system.GetEjection().Mode = remove ? EjectionPolicy::Action::Remove : EjectionPolicy::Action::Ballistic;
+			}
+		}
 
 		ImGui::NewLine();
 		ImGui::Separator();
@@ -165,12 +323,47 @@ void SimulationLayer::RenderControlBar()
 		ImGui::TableNextColumn();
 		ImGui::Text("Simulation time passed [days]");
 		ImGui::TableNextColumn();
-		ImGui::Text("%.10f", m_SimulationTimePassed / 365.0f);
+		ImGui::Text("%.10f", m_Timeline.GetEndTime());
 		ImGui::TableNextRow();
 		ImGui::TableNextColumn();
 		ImGui::Text("Real time passed [seconds]");
 		ImGui::TableNextColumn();
 		ImGui::Text("%.10f", m_RealTimePassed);
+		ImGui::TableNextRow();
+		ImGui::TableNextColumn();
+		ImGui::Text("Physics substep cost [ms]");
+		ImGui::TableNextColumn();
+		ImGui::Text("%.4f", m_Governor.GetStepCostMs());
+		ImGui::TableNextRow();
+		ImGui::TableNextColumn();
+		ImGui::Text("Affordable substeps per tick");
+		ImGui::TableNextColumn();
+		ImGui::Text("%u", m_Governor.GetMaxSubsteps());
+		ImGui::TableNextRow();
+		ImGui::TableNextColumn();
+		ImGui::Text("Bodies on rails");
+		ImGui::TableNextColumn();
+		ImGui::Text("%u", system.GetRails().GetOnRailsCount());
+		ImGui::TableNextRow();
+		ImGui::TableNextColumn();
+		ImGui::Text("Max subsystem substeps");
+		ImGui::TableNextColumn();
+		ImGui::Text("%u", system.GetHierarchy().GetMaxSubsteps());
+		ImGui::TableNextRow();
+		ImGui::TableNextColumn();
+		ImGui::Text("Deactivated bodies");
+		ImGui::TableNextColumn();
+		ImGui::Text("%u", system.GetEjection().GetDeactivatedCount());
+		ImGui::TableNextRow();
+		ImGui::TableNextColumn();
+		ImGui::Text("Timeline keyframes (every n-th step)");
+		ImGui::TableNextColumn();
+		ImGui::Text("%zu (%u)", m_Timeline.GetKeyframeCount(), m_Timeline.GetInterval());
+		ImGui::TableNextRow();
+		ImGui::TableNextColumn();
+		ImGui::Text("Timeline memory [MiB]");
+		ImGui::TableNextColumn();
+		ImGui::Text("%.2f", m_Timeline.GetMemoryUsage() / (1024.0 * 1024.0));
 		ImGui::EndTable();
 
 		ImGui::NewLine();
@@ -193,9 +386,176 @@ void SimulationLayer::RenderControlBar()
 	}
 
 	ImGui::PopID();
+	ImGui::SameLine();
+	ImGui::Text("Time warp: x%.2f", m_IsRunning ? m_Governor.GetAchievedWarp() : 0.0f);
+	RenderTimeline();
 	ImGui::End();
 }
 
+void SimulationLayer::RenderTimeline()
+{
+	bool playback = m_Playback.GetFrameCount() > 0;
+	double firstTime = playback ? m_Playback.GetFrameTime(0) : m_Timeline.GetStartTime();
+	double lastTime = playback ? m_Playback.GetFrameTime(m_Playback.GetFrameCount() - 1) : m_Timeline.GetEndTime();
+
+	if (lastTime <= firstTime)
+	{
+		return;
+	}
+
+	double shownTime = m_IsReplaying ? m_ReplayTime : lastTime;
+
+	ImGui::SameLine();
+	ImGui::SetNextItemWidth(ImGui::GetContentRegionAvail().x);
+
+	// Dragging pauses the simulation and shows past states, playing again continues from where it was paused
+	if (ImGui::SliderScalar("##Timeline", ImGuiDataType_Double, &shownTime, &firstTime, &lastTime, "Day %.2f"))
+	{
+		ScrubTo(shownTime);
+	}
+}
+
+void SimulationLayer::StartRecording()
+{
+	std::filesystem::path directory = std::filesystem::current_path().append("Recordings");
+	std::filesystem::create_directories(directory);
+
+	uint32_t bodyCount = (uint32_t)m_BodyIds.size();
+	std::string path = directory.append(m_Scene->m_SceneName + ".strec").string();
+
+	// Bodies only ever disappear during a run, so the count at the start fits every frame
+	if (!m_Recorder.Open(path, bodyCount, TrajectoryRecorder::FramesForBudget(bodyCount, RECORDING_BUDGET)))
+	{
+		m_IsRecording = false;
+	}
+}
+
+void SimulationLayer::ScrubTo(double time)
+{
+	std::vector<std::unique_ptr<Planet>>& planets = m_Scene->m_Planets;
+
+	if (!m_IsReplaying)
+	{
+		PlanetBodies::TakeSnapshot(planets, m_LiveBodies);
+		m_IsReplaying = true;
+		m_IsRunning = false;
+		m_Governor.Reset();
+	}
+
+	m_ReplayTime = time;
+
+	if (m_Playback.GetFrameCount() > 0)
+	{
+		m_Timeline.Cancel();
+
+		if (m_Playback.ReadFrame(m_Playback.FindFrame(time), m_ReplayFrame))
+		{
+			ShowFrame(m_ReplayFrame);
+		}
+
+		return;
+	}
+
+	// Recorded frames show up right away, anything older gets re-simulated and shown once it's done
+	if (m_Recorder.GetFrameCount() > 0 && time >= m_Recorder.GetFrameTime(0))
+	{
+		m_Timeline.Cancel();
+		m_Recorder.ReadFrame(m_Recorder.FindFrame(time), m_ReplayFrame);
+		ShowFrame(m_ReplayFrame);
+
+		return;
+	}
+
+	m_Timeline.Seek(time);
+}
+
+void SimulationLayer::ShowFrame(const TrajectoryRecorder::Frame& frame)
+{
+	std::vector<std::unique_ptr<Planet>>& planets = m_Scene->m_Planets;
+
+	// Both id lists are ascending, bodies removed since the frame was recorded have no planet left to show them
+	size_t frameIdx = 0;
+
+	for (size_t i = 0; i < planets.size(); i++)
+	{
+		while (frameIdx < frame.BodyIds.size() && frame.BodyIds[frameIdx] < m_BodyIds[i])
+		{
+			frameIdx++;
+		}
+
+		if (frameIdx < frame.BodyIds.size() && frame.BodyIds[frameIdx] == m_BodyIds[i])
+		{
+			planets[i]->GetTransform().Position = frame.Positions[frameIdx];
+			planets[i]->GetPhysics().LinearVelocity = frame.Velocities[frameIdx];
+		}
+	}
+}
+
+void SimulationLayer::ExportRecording()
+{
+	// Rewriting the file under its own mapping would pull the pages out from under the reader
+	SetPlayback(false);
+
+	m_ExportJob = JobSystem::Submit([this, path = GetExportPath()]()
+		{
+			TrajectoryWriter writer;
+
+			if (!writer.Open(path, {}))
+			{
+				return;
+			}
+
+			TrajectoryRecorder::Frame frame;
+
+			for (uint64_t frameIdx = 0; frameIdx < m_Recorder.GetFrameCount(); frameIdx++)
+			{
+				m_Recorder.ReadFrame(frameIdx, frame);
+				writer.Append(frame.BodyIds, frame.Positions, frame.Velocities, frame.Time);
+			}
+
+			writer.Close();
+
+			LOG_INFO("Exported {} recorded frames to {}, {:.1f}x smaller than the recording.", writer.GetFrameCount(), path,
+				(double)writer.GetRawBytes() / std::max<uint64_t>(writer.GetWrittenBytes(), 1));
+		});
+}
+
+void SimulationLayer::SetPlayback(bool enabled)
+{
+	// Frame on screen may come from the file about to be closed
+	if (m_IsReplaying)
+	{
+		LeaveReplay();
+	}
+
+	m_Playback.Close();
+
+	if (enabled && m_Playback.Open(GetExportPath()) && m_Playback.GetFrameCount() == 0)
+	{
+		m_Playback.Close();
+	}
+}
+
+std::string SimulationLayer::GetExportPath() const
+{
+	return std::filesystem::current_path().append("Recordings").append(m_Scene->m_SceneName + ".strz").string();
+}
+
+void SimulationLayer::LeaveReplay()
+{
+	m_Timeline.Cancel();
+
+	std::vector<std::unique_ptr<Planet>>& planets = m_Scene->m_Planets;
+
+	for (size_t i = 0; i < planets.size(); i++)
+	{
+		planets[i]->GetTransform().Position = m_LiveBodies.Positions[i];
+		planets[i]->GetPhysics().LinearVelocity = m_LiveBodies.Velocities[i];
+	}
+
+	m_IsReplaying = false;
+}
+
 void SimulationLayer::RenderViewport()
 {
 	WindowSpec windowSpec = Application::GetInstance()->GetWindowSpec();
@@ -212,3 +572,105 @@ void SimulationLayer::RenderViewport()
 	ImGui::End();
 	ImGui::PopStyleVar();
 }
+
+void SimulationLayer::RenderConservationPanel()
+{
+	const ConservationMonitor& monitor = m_Scene->m_System.GetConservation();
+	const ConservationStats& initial = monitor.GetInitial();
+	const ConservationStats& current = monitor.GetCurrent();
+
+	ImGui::SetNextWindowSize({ 512.0f, 240.0f }, ImGuiCond_FirstUseEver);
+	ImGui::Begin("Conservation");
+
+	if (ImGui::BeginTable("##Conservation", 4, ImGuiTableFlags_Borders))
+	{
+		ImGui::TableNextRow();
+		ImGui::TableNextColumn();
+		ImGui::TableNextColumn();
+		ImGui::Text("Initial");
+		ImGui::TableNextColumn();
+		ImGui::Text("Current");
+		ImGui::TableNextColumn();
+		ImGui::Text("Relative drift");
+
+		ImGui::TableNextRow();
+		ImGui::TableNextColumn();
+		ImGui::Text("Energy");
+		ImGui::TableNextColumn();
+		ImGui::Text("%.6e", initial.Energy());
+		ImGui::TableNextColumn();
+		ImGui::Text("%.6e", current.Energy());
+		ImGui::TableNextColumn();
+		ImGui::Text("%.3e", monitor.GetEnergyDrift());
+
+		ImGui::TableNextRow();
+		ImGui::TableNextColumn();
+		ImGui::Text("Momentum");
+		ImGui::TableNextColumn();
+		ImGui::Text("%.6e", glm::length(initial.Momentum));
+		ImGui::TableNextColumn();
+		ImGui::Text("%.6e", glm::length(current.Momentum));
+		ImGui::TableNextColumn();
+		ImGui::Text("%.3e", monitor.GetMomentumDrift());
+
+		ImGui::TableNextRow();
+		ImGui::TableNextColumn();
+		ImGui::Text("Angular momentum");
+		ImGui::TableNextColumn();
+		ImGui::Text("%.6e", glm::length(initial.AngularMomentum));
+		ImGui::TableNextColumn();
+		ImGui::Text("%.6e", glm::length(current.AngularMomentum));
+		ImGui::TableNextColumn();
+		ImGui::Text("%.3e", monitor.GetAngularMomentumDrift());
+
+		ImGui::EndTable();
+	}
+
+	ImGui::NewLine();
+	ImGui::Checkbox("Log drift", &m_Scene->m_System.GetConservation().LogEnabled);
+	ImGui::End();
+}
+
+void SimulationLayer::RenderEventsPanel()
+{
+	const std::deque<SimEvent>& events = m_Scene->m_System.GetEvents().GetEvents();
+	const std::vector<std::unique_ptr<Planet>>& planets = m_Scene->m_Planets;
+
+	auto bodyTag = [&planets](uint32_t idx) { return idx < planets.size() ? planets[idx]->GetTag() : std::string("?"); };
+
+	ImGui::SetNextWindowSize({ 512.0f, 240.0f }, ImGuiCond_FirstUseEver);
+	ImGui::Begin("Events");
+	ImGui::Checkbox("Log events", &m_Scene->m_System.GetEvents().LogEnabled);
+	ImGui::NewLine();
+
+	if (ImGui::BeginTable("##Events", 5, ImGuiTableFlags_Borders | ImGuiTableFlags_ScrollY))
+	{
+		ImGui::TableSetupScrollFreeze(0, 1);
+		ImGui::TableSetupColumn("Time [days]");
+		ImGui::TableSetupColumn("Event");
+		ImGui::TableSetupColumn("Body");
+		ImGui::TableSetupColumn("Other");
+		ImGui::TableSetupColumn("Distance");
+		ImGui::TableHeadersRow();
+
+		// Newest on top
+		for (auto it = events.rbegin(); it != events.rend(); it++)
+		{
+			ImGui::TableNextRow();
+			ImGui::TableNextColumn();
+			ImGui::Text("%.6f", it->Time);
+			ImGui::TableNextColumn();
+			ImGui::Text("%s", SimEventTypeName(it->EventType));
+			ImGui::TableNextColumn();
+			ImGui::Text("%s", bodyTag(it->Body).c_str());
+			ImGui::TableNextColumn();
+			ImGui::Text("%s", bodyTag(it->Other).c_str());
+			ImGui::TableNextColumn();
+			ImGui::Text("%.4f", it->Distance);
+		}
+
+		ImGui::EndTable();
+	}
+
+	ImGui::End();
+}
\ No newline at end of file
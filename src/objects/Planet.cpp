@@ -28,9 +28,14 @@ void Planet::OnUpdate(float ts)
 
 void Planet::OnTick()
 {
-	glm::vec3 move = m_Physics.LinearVelocity * Application::TPS_STEP * Application::TPS_MULTIPLIER;
+	Advance(SimClock::TPS_MULTIPLIER);
+}
+
+void Planet::Advance(float timeScale)
+{
+	glm::vec3 move = m_Physics.LinearVelocity * SimClock::TPS_STEP * timeScale;
 
-	m_Transform.Position += move * (20.0f * glm::pi<float>() / 365.0f);
+	m_Transform.Position += move * SimPhysics::VELOCITY_SCALE;
 }
 
 void Planet::OnConfigRender()
@@ -18,6 +18,8 @@ public:
 
 	virtual std::unique_ptr<Planet> Clone();
 
+	void Advance(float timeScale);
+
 	inline Physics&  GetPhysics()  { return m_Physics;  }
 	inline Material& GetMaterial() { return m_Material; }
 
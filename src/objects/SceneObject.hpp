@@ -37,8 +37,6 @@ public:
 
 	inline static constexpr uint32_t MAX_OBJECTS = 254;
 
-	static void CleanLastNIDs(int32_t N) { s_IdCounter -= N; }
-
 protected:
 	std::string m_Tag;
 	Transform m_Transform;
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <vector>
+#include <cstdint>
+
+// Plain arrays of everything the integrator needs, one entry per body.
+// Cheap to copy and step on any thread, unlike the scene's Planet objects.
+struct BodyStore
+{
+	std::vector<glm::vec3> Positions;
+	std::vector<glm::vec3> Velocities;
+	std::vector<float> Masses;
+
+	inline size_t Size() const { return Masses.size(); }
+
+	void Resize(size_t count)
+	{
+		Positions.resize(count);
+		Velocities.resize(count);
+		Masses.resize(count);
+	}
+
+	void Clear()
+	{
+		Positions.clear();
+		Velocities.clear();
+		Masses.clear();
+	}
+
+	// FNV-1a over the raw bits, equal hashes mean bitwise equal states for any practical purpose
+	uint64_t Hash() const
+	{
+		uint64_t hash = 0xCBF29CE484222325ull;
+
+		auto mix = [&hash](const void* data, size_t size)
+			{
+				const uint8_t* bytes = (const uint8_t*)data;
+
+				for (size_t i = 0; i < size; i++)
+				{
+					hash = (hash ^ bytes[i]) * 0x100000001B3ull;
+				}
+			};
+
+		mix(Positions.data(), Positions.size() * sizeof(glm::vec3));
+		mix(Velocities.data(), Velocities.size() * sizeof(glm::vec3));
+		mix(Masses.data(), Masses.size() * sizeof(float));
+
+		return hash;
+	}
+};
\ No newline at end of file
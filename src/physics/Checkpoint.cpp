@@ -0,0 +1,161 @@
+#include "Checkpoint.hpp"
+#include "SystemIntegrator.hpp"
+#include "SimClock.hpp"
+#include "StateArchive.hpp"
+#include "../Logger.hpp"
+#include "../random_utils/FileUtils.hpp"
+
+#include <fstream>
+#include <cstring>
+
+Checkpoint Checkpoint::Capture(const BodyStore& bodies, const std::vector<uint32_t>& bodyIds, const SystemIntegrator& system, uint64_t step)
+{
+	Checkpoint checkpoint;
+	checkpoint.Step = step;
+	checkpoint.GMultiplier = system.GMultiplier;
+	checkpoint.TimeScale = SimClock::TPS_MULTIPLIER;
+	checkpoint.Deterministic = SimClock::DETERMINISTIC;
+	checkpoint.Bodies = bodies;
+	checkpoint.BodyIds = bodyIds;
+
+	StateWriter writer;
+	system.SaveState(writer);
+	checkpoint.IntegratorState = writer.GetData();
+
+	return checkpoint;
+}
+
+bool Checkpoint::Restore(SystemIntegrator& system) const
+{
+	StateReader reader(IntegratorState.data(), IntegratorState.size());
+
+	if (!system.LoadState(reader))
+	{
+		system.Reset();
+
+		return false;
+	}
+
+	system.GMultiplier = GMultiplier;
+	SimClock::TPS_MULTIPLIER = TimeScale;
+
+	return true;
+}
+
+std::optional<Checkpoint> Checkpoint::Read(const std::string& path)
+{
+	std::ifstream file(path, std::ios::in | std::ios::binary);
+	if (!file.good())
+	{
+		LOG_ERROR("Checkpoint {} could not be opened.", path);
+
+		return {};
+	}
+
+	std::vector<uint8_t> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+	StateReader reader(data.data(), data.size());
+
+	char header[9]{};
+	int32_t version = 0;
+
+	for (char& c : header)
+	{
+		reader.Read(c);
+	}
+
+	reader.Read(version);
+
+	if (strncmp(header, "SSSCHKPT", 9) != 0 || version != VERSION)
+	{
+		LOG_ERROR("{} is not a checkpoint of this version.", path);
+
+		return {};
+	}
+
+	Checkpoint checkpoint;
+	reader.Read(checkpoint.Step);
+	reader.Read(checkpoint.GMultiplier);
+	reader.Read(checkpoint.TimeScale);
+	reader.Read(checkpoint.Deterministic);
+	reader.Read(checkpoint.SourceHash);
+	reader.ReadVector(checkpoint.Bodies.Positions);
+	reader.ReadVector(checkpoint.Bodies.Velocities);
+	reader.ReadVector(checkpoint.Bodies.Masses);
+	reader.ReadVector(checkpoint.BodyIds);
+	reader.ReadVector(checkpoint.IntegratorState);
+
+	bool consistent = checkpoint.Bodies.Positions.size() == checkpoint.Bodies.Size()
+		&& checkpoint.Bodies.Velocities.size() == checkpoint.Bodies.Size()
+		&& checkpoint.BodyIds.size() == checkpoint.Bodies.Size();
+
+	if (reader.Failed() || !consistent)
+	{
+		LOG_ERROR("Checkpoint {} is truncated or corrupted.", path);
+
+		return {};
+	}
+
+	return checkpoint;
+}
+
+bool Checkpoint::Write(const std::string& path) const
+{
+	StateWriter writer;
+
+	for (char c : "SSSCHKPT")
+	{
+		writer.Write(c);
+	}
+
+	writer.Write(VERSION);
+	writer.Write(Step);
+	writer.Write(GMultiplier);
+	writer.Write(TimeScale);
+	writer.Write(Deterministic);
+	writer.Write(SourceHash);
+	writer.WriteVector(Bodies.Positions);
+	writer.WriteVector(Bodies.Velocities);
+	writer.WriteVector(Bodies.Masses);
+	writer.WriteVector(BodyIds);
+	writer.WriteVector(IntegratorState);
+
+	if (!FileUtils::WriteAtomically(path, writer.GetData().data(), writer.GetData().size()))
+	{
+		LOG_ERROR("Checkpoint {} could not be written.", path);
+
+		return false;
+	}
+
+	return true;
+}
+
+CheckpointWriter::~CheckpointWriter()
+{
+	Wait();
+}
+
+bool CheckpointWriter::WriteAsync(Checkpoint&& checkpoint, const std::string& path)
+{
+	// Simulation never waits on the disk, a slow write just means this checkpoint gets skipped
+	if (!JobSystem::IsDone(m_Job))
+	{
+		LOG_WARN("Previous checkpoint still being written, skipping the one at step {}.", checkpoint.Step);
+
+		return false;
+	}
+
+	m_Job = JobSystem::Submit([checkpoint = std::move(checkpoint), path]()
+		{
+			if (checkpoint.Write(path))
+			{
+				LOG_INFO("Checkpoint at step {} written to {}.", checkpoint.Step, path);
+			}
+		});
+
+	return true;
+}
+
+void CheckpointWriter::Wait()
+{
+	JobSystem::Wait(m_Job);
+}
\ No newline at end of file
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "BodyStore.hpp"
+#include "../JobSystem.hpp"
+
+#include <string>
+#include <optional>
+#include <vector>
+#include <cstdint>
+
+class SystemIntegrator;
+
+// Full dynamic state of a running simulation: the bodies, the integrator with every part of it, the step counter,
+// the G multiplier it stepped with and the global time scale. Resuming from one continues bit for bit where the run left off.
+struct Checkpoint
+{
+	uint64_t Step = 0;
+	float GMultiplier = 1.0f;
+	float TimeScale = 1.0f;
+
+	// SimClock::DETERMINISTIC of the run, summation order differs without it so resuming has to keep it
+	bool Deterministic = false;
+
+	// Owner's fingerprint of where the run started, e.g. BodyStore::Hash of the scene's bodies, 0 when unused
+	uint64_t SourceHash = 0;
+
+	BodyStore Bodies;
+
+	// Owner's id of every body, e.g. its index in the scene file the run started from
+	std::vector<uint32_t> BodyIds;
+
+	// SystemIntegrator::SaveState output
+	std::vector<uint8_t> IntegratorState;
+
+	static Checkpoint Capture(const BodyStore& bodies, const std::vector<uint32_t>& bodyIds, const SystemIntegrator& system, uint64_t step);
+
+	// Puts the integrator, its G multiplier and the global time scale back the way they were, the bodies are up to the caller
+	bool Restore(SystemIntegrator& system) const;
+
+	static std::optional<Checkpoint> Read(const std::string& path);
+
+	// Written next to path first, flushed and renamed over it, so a crash mid-write leaves the previous checkpoint intact
+	bool Write(const std::string& path) const;
+
+	inline static constexpr int32_t VERSION = 3;
+};
+
+// Writes checkpoints on a worker, the simulation only pays for copying its state
+class CheckpointWriter
+{
+public:
+	CheckpointWriter() = default;
+	~CheckpointWriter();
+
+	// Returns false without writing anything when the previous checkpoint is still being written
+	bool WriteAsync(Checkpoint&& checkpoint, const std::string& path);
+	void Wait();
+
+	// Steps between checkpoints, 0 turns them off
+	uint64_t Interval = 0;
+
+private:
+	JobHandle m_Job;
+};
\ No newline at end of file
@@ -0,0 +1,65 @@
+#include "Conservation.hpp"
+#include "StateArchive.hpp"
+#include "../Logger.hpp"
+
+#include <cmath>
+
+void ConservationMonitor::Record(const ConservationStats& stats)
+{
+	if (m_RecordCount == 0)
+	{
+		m_Initial = stats;
+	}
+
+	m_Current = stats;
+
+	if (LogEnabled && LogInterval != 0 && m_RecordCount % LogInterval == 0)
+	{
+		LOG_INFO("Conservation drift after {} steps: energy {:.3e}, momentum {:.3e}, angular momentum {:.3e}",
+			m_RecordCount, GetEnergyDrift(), GetMomentumDrift(), GetAngularMomentumDrift());
+	}
+
+	m_RecordCount++;
+}
+
+void ConservationMonitor::Reset()
+{
+	m_Initial = ConservationStats{};
+	m_Current = ConservationStats{};
+	m_RecordCount = 0;
+}
+
+double ConservationMonitor::GetEnergyDrift() const
+{
+	double initial = m_Initial.Energy();
+
+	return initial != 0.0 ? std::abs((m_Current.Energy() - initial) / initial) : 0.0;
+}
+
+double ConservationMonitor::GetMomentumDrift() const
+{
+	return m_Initial.MomentumScale > 0.0 ? glm::length(m_Current.Momentum - m_Initial.Momentum) / m_Initial.MomentumScale : 0.0;
+}
+
+double ConservationMonitor::GetAngularMomentumDrift() const
+{
+	double initial = glm::length(m_Initial.AngularMomentum);
+
+	return initial > 0.0 ? glm::length(m_Current.AngularMomentum - m_Initial.AngularMomentum) / initial : 0.0;
+}
+
+void ConservationMonitor::SaveState(StateWriter& writer) const
+{
+	writer.Write(m_Initial);
+	writer.Write(m_Current);
+	writer.Write(m_RecordCount);
+}
+
+bool ConservationMonitor::LoadState(StateReader& reader)
+{
+	reader.Read(m_Initial);
+	reader.Read(m_Current);
+	reader.Read(m_RecordCount);
+
+	return !reader.Failed();
+}
\ No newline at end of file
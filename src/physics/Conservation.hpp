@@ -0,0 +1,53 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+
+// Quantities an exact integration would keep constant. Energy is in the simulation's own units:
+// kinetic = VELOCITY_SCALE / 2 * sum(m * v^2), potential = -K * sum over pairs(m1 * m2 / r).
+struct ConservationStats
+{
+	double Kinetic = 0.0;
+	double Potential = 0.0;
+	glm::dvec3 Momentum = { 0.0, 0.0, 0.0 };
+	glm::dvec3 AngularMomentum = { 0.0, 0.0, 0.0 };
+
+	// Sum of |m * v|, the scale momentum drift gets measured against since total momentum is usually near zero
+	double MomentumScale = 0.0;
+
+	inline double Energy() const { return Kinetic + Potential; }
+};
+
+class StateWriter;
+class StateReader;
+
+// Tracks how far a run drifted from the quantities it started with
+class ConservationMonitor
+{
+public:
+	void Record(const ConservationStats& stats);
+	void Reset();
+
+	// Everything the next steps depend on, for checkpoints. Loading fails on data written by anything else.
+	void SaveState(StateWriter& writer) const;
+	bool LoadState(StateReader& reader);
+
+	inline const ConservationStats& GetInitial() const { return m_Initial; }
+	inline const ConservationStats& GetCurrent() const { return m_Current; }
+	inline uint64_t GetRecordCount() const { return m_RecordCount; }
+
+	// All relative to the initial values
+	double GetEnergyDrift() const;
+	double GetMomentumDrift() const;
+	double GetAngularMomentumDrift() const;
+
+	// Writes the drift to the log every LogInterval records, for runs nobody watches
+	bool LogEnabled = false;
+	uint32_t LogInterval = 240;
+
+private:
+	ConservationStats m_Initial;
+	ConservationStats m_Current;
+	uint64_t m_RecordCount = 0;
+};
\ No newline at end of file
@@ -0,0 +1,105 @@
+#include "EjectionPolicy.hpp"
+#include "../Simulator.hpp"
+#include "StateArchive.hpp"
+
+#include <algorithm>
+
+bool EjectionPolicy::Evaluate(const BodyStore& bodies, float gMultiplier)
+{
+	if (m_Mask.size() != bodies.Size())
+	{
+		Reset();
+		m_Mask.resize(bodies.Size(), 0);
+		m_SavedMasses.resize(bodies.Size(), 0.0f);
+	}
+
+	if (m_StepsSinceEvaluation++ % EVALUATE_INTERVAL != 0)
+	{
+		return false;
+	}
+
+	// Escaping is checked against the active bodies only, ballistic ones are as good as gone
+	m_Escaping.clear();
+	SimPhysics::FindEscapingBodies(bodies, Radius, &m_Mask, m_Escaping, gMultiplier);
+
+	for (uint32_t idx : m_Escaping)
+	{
+		m_Mask[idx] = 1;
+	}
+
+	m_DeactivatedCount += (uint32_t)m_Escaping.size();
+
+	return !m_Escaping.empty();
+}
+
+void EjectionPolicy::Apply(BodyStore& bodies)
+{
+	for (size_t i = 0; i < m_Mask.size() && i < bodies.Size(); i++)
+	{
+		if (!m_Mask[i])
+		{
+			continue;
+		}
+
+		// Already zero when the store lived on since the last step, the saved mass is still the one
+		if (bodies.Masses[i] != 0.0f)
+		{
+			m_SavedMasses[i] = bodies.Masses[i];
+		}
+
+		bodies.Masses[i] = 0.0f;
+	}
+}
+
+void EjectionPolicy::Restore(BodyStore& bodies) const
+{
+	for (size_t i = 0; i < m_Mask.size() && i < bodies.Size(); i++)
+	{
+		if (m_Mask[i])
+		{
+			bodies.Masses[i] = m_SavedMasses[i];
+		}
+	}
+}
+
+void EjectionPolicy::DropDeactivated()
+{
+	size_t remaining = std::count(m_Mask.begin(), m_Mask.end(), 0);
+
+	m_Mask.assign(remaining, 0);
+	m_SavedMasses.assign(remaining, 0.0f);
+}
+
+void EjectionPolicy::Reset()
+{
+	m_Mask.clear();
+	m_SavedMasses.clear();
+	m_Escaping.clear();
+	m_StepsSinceEvaluation = 0;
+	m_DeactivatedCount = 0;
+}
+
+void EjectionPolicy::SaveState(StateWriter& writer) const
+{
+	writer.Write(Enabled);
+	writer.Write(Mode);
+	writer.Write(Radius);
+	writer.WriteVector(m_Mask);
+	writer.WriteVector(m_SavedMasses);
+	writer.Write(m_StepsSinceEvaluation);
+	writer.Write(m_DeactivatedCount);
+}
+
+bool EjectionPolicy::LoadState(StateReader& reader)
+{
+	reader.Read(Enabled);
+	reader.Read(Mode);
+	reader.Read(Radius);
+	reader.ReadVector(m_Mask);
+	reader.ReadVector(m_SavedMasses);
+	reader.Read(m_StepsSinceEvaluation);
+	reader.Read(m_DeactivatedCount);
+	m_Escaping.clear();
+
+	return !reader.Failed() && m_SavedMasses.size() == m_Mask.size();
+}
\ No newline at end of file
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "BodyStore.hpp"
+
+#include <vector>
+#include <cstdint>
+
+class StateWriter;
+class StateReader;
+
+// Takes bodies that left the system for good out of the O(N^2) force pass.
+// Depending on the action they either keep drifting in a ballistic group that nothing pulls on and that pulls on nothing,
+// or get removed from the scene altogether, which is up to the owner of the bodies.
+class EjectionPolicy
+{
+public:
+	enum class Action
+	{
+		Ballistic,
+		Remove
+	};
+
+	// Looks for new escapees every EVALUATE_INTERVAL calls, returns true when it found any
+	bool Evaluate(const BodyStore& bodies, float gMultiplier);
+
+	// Ballistic bodies lose their mass, every integrator already lets massless bodies drift.
+	// The mass is kept here, the bodies may be a fresh snapshot every step or live on between them.
+	void Apply(BodyStore& bodies);
+
+	// Gives ballistic bodies their masses back, before a Reset that would forget them
+	void Restore(BodyStore& bodies) const;
+
+	// For the remove action, called once the owner erased every flagged body. Keeps the count going.
+	void DropDeactivated();
+
+	void Reset();
+
+	// Everything the next steps depend on, for checkpoints. Loading fails on data written by anything else.
+	void SaveState(StateWriter& writer) const;
+	bool LoadState(StateReader& reader);
+
+	inline const std::vector<uint8_t>& GetMask() const { return m_Mask; }
+	inline uint32_t GetDeactivatedCount() const { return m_DeactivatedCount; }
+
+	bool Enabled = false;
+	Action Mode = Action::Ballistic;
+
+	// Bodies closer than this to the rest of the system are never deactivated [distance units]
+	float Radius = 500.0f;
+
+	inline static constexpr uint32_t EVALUATE_INTERVAL = 60;
+
+private:
+	std::vector<uint8_t> m_Mask;
+	std::vector<float> m_SavedMasses;
+	std::vector<uint32_t> m_Escaping;
+
+	uint32_t m_StepsSinceEvaluation = 0;
+	uint32_t m_DeactivatedCount = 0;
+};
\ No newline at end of file
@@ -0,0 +1,147 @@
+#include "EnsembleIntegrator.hpp"
+#include "../Simulator.hpp"
+#include "SimClock.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+EnsembleIntegrator::EnsembleIntegrator(const BodyStore& bodies, size_t targetIdx, uint32_t members, float spreadAngle)
+	: m_BodyCount(bodies.Size()), m_Members(std::max(members, 1u))
+{
+	size_t laneCount = m_BodyCount * m_Members;
+
+	for (std::vector<float>* lanes : { &m_PosX, &m_PosY, &m_PosZ, &m_VelX, &m_VelY, &m_VelZ, &m_AccX, &m_AccY, &m_AccZ })
+	{
+		lanes->resize(laneCount);
+	}
+
+	m_Masses = bodies.Masses;
+
+	for (size_t i = 0; i < m_BodyCount; i++)
+	{
+		for (uint32_t k = 0; k < m_Members; k++)
+		{
+			size_t lane = i * m_Members + k;
+
+			m_PosX[lane] = bodies.Positions[i].x;
+			m_PosY[lane] = bodies.Positions[i].y;
+			m_PosZ[lane] = bodies.Positions[i].z;
+			m_VelX[lane] = bodies.Velocities[i].x;
+			m_VelY[lane] = bodies.Velocities[i].y;
+			m_VelZ[lane] = bodies.Velocities[i].z;
+		}
+	}
+
+	// Basis perpendicular to the velocity, members are spread evenly around it
+	glm::vec3 velocity = bodies.Velocities[targetIdx];
+	float speed = glm::length(velocity);
+	glm::vec3 forward = speed > 0.0f ? velocity / speed : glm::vec3(1.0f, 0.0f, 0.0f);
+	glm::vec3 helper = std::abs(forward.y) < 0.99f ? glm::vec3(0.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.0f, 0.0f);
+	glm::vec3 side = glm::normalize(glm::cross(forward, helper));
+	glm::vec3 up = glm::cross(side, forward);
+
+	for (uint32_t k = 1; k < m_Members; k++)
+	{
+		float around = 2.0f * glm::pi<float>() * (float)(k - 1) / (float)(m_Members - 1);
+		glm::vec3 tilt = std::cos(around) * side + std::sin(around) * up;
+		glm::vec3 perturbed = speed > 0.0f
+			? speed * (std::cos(spreadAngle) * forward + std::sin(spreadAngle) * tilt)
+			: spreadAngle * tilt;
+
+		size_t lane = targetIdx * m_Members + k;
+
+		m_VelX[lane] = perturbed.x;
+		m_VelY[lane] = perturbed.y;
+		m_VelZ[lane] = perturbed.z;
+	}
+}
+
+void EnsembleIntegrator::Step(float timeScale)
+{
+	// Same acceleration as SimPhysics::AccelerateAll with m1 cancelled out, in floats to fit twice the members per vector
+	const float forceScale = (float)((double)SimPhysics::G_CONSTANT_MULTIPLIER * SimPhysics::SCALE_FACTOR / SimPhysics::SUN_MASS);
+	const float dt = SimClock::TPS_STEP * timeScale;
+	const uint32_t M = m_Members;
+
+	for (size_t i = 0; i < m_BodyCount; i++)
+	{
+		if (m_Masses[i] <= 0.0f)
+		{
+			continue;
+		}
+
+		float* accX = &m_AccX[i * M];
+		float* accY = &m_AccY[i * M];
+		float* accZ = &m_AccZ[i * M];
+		const float* posX = &m_PosX[i * M];
+		const float* posY = &m_PosY[i * M];
+		const float* posZ = &m_PosZ[i * M];
+
+		for (uint32_t k = 0; k < M; k++)
+		{
+			accX[k] = 0.0f;
+			accY[k] = 0.0f;
+			accZ[k] = 0.0f;
+		}
+
+		for (size_t j = 0; j < m_BodyCount; j++)
+		{
+			if (j == i || m_Masses[j] <= 0.0f)
+			{
+				continue;
+			}
+
+			const float* otherX = &m_PosX[j * M];
+			const float* otherY = &m_PosY[j * M];
+			const float* otherZ = &m_PosZ[j * M];
+			float strength = m_Masses[j] * forceScale;
+
+			for (uint32_t k = 0; k < M; k++)
+			{
+				float dx = otherX[k] - posX[k];
+				float dy = otherY[k] - posY[k];
+				float dz = otherZ[k] - posZ[k];
+				float distance2 = dx * dx + dy * dy + dz * dz;
+
+				// Select instead of branching keeps the lanes in lockstep when two bodies overlap
+				float invDistance = distance2 > 0.0f ? 1.0f / std::sqrt(distance2) : 0.0f;
+				float scale = strength * invDistance * invDistance * invDistance;
+
+				accX[k] += dx * scale;
+				accY[k] += dy * scale;
+				accZ[k] += dz * scale;
+			}
+		}
+	}
+
+	for (size_t i = 0; i < m_BodyCount; i++)
+	{
+		if (m_Masses[i] <= 0.0f)
+		{
+			continue;
+		}
+
+		for (size_t lane = i * M; lane < (i + 1) * M; lane++)
+		{
+			m_VelX[lane] += dt * m_AccX[lane];
+			m_VelY[lane] += dt * m_AccY[lane];
+			m_VelZ[lane] += dt * m_AccZ[lane];
+		}
+	}
+
+	const float move = dt * SimPhysics::VELOCITY_SCALE;
+
+	for (size_t lane = 0; lane < m_PosX.size(); lane++)
+	{
+		m_PosX[lane] += m_VelX[lane] * move;
+		m_PosY[lane] += m_VelY[lane] * move;
+		m_PosZ[lane] += m_VelZ[lane] * move;
+	}
+}
+
+glm::vec3 EnsembleIntegrator::GetPosition(size_t bodyIdx, uint32_t member) const
+{
+	size_t lane = bodyIdx * m_Members + member;
+
+	return { m_PosX[lane], m_PosY[lane], m_PosZ[lane] };
+}
\ No newline at end of file
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "BodyStore.hpp"
+
+#include <glm/glm.hpp>
+
+#include <vector>
+#include <cstdint>
+
+// Integrates several copies of one scene side by side, each with the target's velocity tilted a bit differently.
+// Values of all copies sit next to each other for every body, [body * members + member],
+// so the innermost loops run over members with identical control flow and vectorize cleanly.
+class EnsembleIntegrator
+{
+public:
+	// Member 0 keeps the original velocity, the rest tilt it by spreadAngle [radians] around a cone
+	EnsembleIntegrator(const BodyStore& bodies, size_t targetIdx, uint32_t members, float spreadAngle);
+
+	void Step(float timeScale);
+
+	glm::vec3 GetPosition(size_t bodyIdx, uint32_t member) const;
+	inline uint32_t GetMemberCount() const { return m_Members; }
+
+	// Plenty for a readable cone, and a multiple of the common float vector widths
+	inline static constexpr uint32_t DEFAULT_MEMBERS = 8;
+
+private:
+	size_t m_BodyCount = 0;
+	uint32_t m_Members = 0;
+
+	std::vector<float> m_PosX, m_PosY, m_PosZ;
+	std::vector<float> m_VelX, m_VelY, m_VelZ;
+	std::vector<float> m_AccX, m_AccY, m_AccZ;
+	std::vector<float> m_Masses;
+};
\ No newline at end of file
@@ -0,0 +1,267 @@
+#include "EventDetector.hpp"
+#include "../Simulator.hpp"
+#include "SimClock.hpp"
+#include "StateArchive.hpp"
+#include "../Logger.hpp"
+
+#include <glm/gtx/norm.hpp>
+
+#include <cmath>
+
+const char* SimEventTypeName(SimEvent::Type type)
+{
+	switch (type)
+	{
+	case SimEvent::Type::CloseApproach: return "Close approach";
+	case SimEvent::Type::Periapsis:		return "Periapsis";
+	case SimEvent::Type::SoiEnter:		return "SOI enter";
+	case SimEvent::Type::SoiExit:		return "SOI exit";
+	}
+
+	return "Unknown";
+}
+
+void EventDetector::Detect(const BodyStore& before, const BodyStore& after, float timeScale)
+{
+	uint32_t count = (uint32_t)after.Size();
+
+	m_StepDuration = (double)SimClock::TPS_STEP * timeScale;
+
+	if (before.Size() != after.Size())
+	{
+		Reset();
+		m_Time += m_StepDuration;
+
+		return;
+	}
+
+	if (m_CurrentSoi.size() != count || m_StepsSinceBuild++ % SOI_REBUILD_INTERVAL == 0)
+	{
+		m_Tree.Build(before);
+		m_CurrentSoi = m_Tree.Parents;
+		m_StepsSinceBuild = 1;
+	}
+
+	Interpolant path{ &before, &after, (double)SimPhysics::VELOCITY_SCALE * m_StepDuration };
+
+	// Rate of change of the distance between two bodies is negative while they close in, a minimum is a - to + crossing
+	auto rangeRate = [&path](uint32_t body, uint32_t other, double t)
+		{
+			return glm::dot(path.Position(other, t) - path.Position(body, t), path.Velocity(other, t) - path.Velocity(body, t));
+		};
+
+	for (uint32_t i = 0; i < count; i++)
+	{
+		for (uint32_t j = i + 1; j < count; j++)
+		{
+			if (rangeRate(i, j, 0.0) >= 0.0 || rangeRate(i, j, 1.0) < 0.0)
+			{
+				continue;
+			}
+
+			double t = Bisect([&](double s) { return rangeRate(i, j, s); });
+			float distance = (float)glm::distance(path.Position(i, t), path.Position(j, t));
+
+			if (distance < CloseApproachDistance)
+			{
+				Emit(SimEvent::Type::CloseApproach, i, j, t, distance);
+			}
+		}
+	}
+
+	for (uint32_t i = 0; i < count; i++)
+	{
+		int32_t parent = m_CurrentSoi[i];
+
+		if (parent >= 0 && rangeRate((uint32_t)parent, i, 0.0) < 0.0 && rangeRate((uint32_t)parent, i, 1.0) >= 0.0)
+		{
+			double t = Bisect([&](double s) { return rangeRate((uint32_t)parent, i, s); });
+
+			Emit(SimEvent::Type::Periapsis, i, (uint32_t)parent, t, (float)glm::distance(path.Position(i, t), path.Position(parent, t)));
+		}
+
+		if (after.Masses[i] <= 0.0f)
+		{
+			continue;
+		}
+
+		int32_t newParent = FindSoi(after, i);
+
+		if (newParent == parent)
+		{
+			continue;
+		}
+
+		// Boundary of a sphere of influence is where the distance to its owner equals its radius
+		auto boundary = [&](uint32_t owner)
+			{
+				return [&, owner](double s) { return glm::distance(path.Position(i, s), path.Position(owner, s)) - m_Tree.Radii[owner]; };
+			};
+
+		// Same bracket check as the approaches, a switch between spheres without a crossing inside the step has nothing to bisect
+		if (parent >= 0 && boundary((uint32_t)parent)(0.0) < 0.0 && boundary((uint32_t)parent)(1.0) >= 0.0)
+		{
+			double t = Bisect(boundary((uint32_t)parent));
+
+			Emit(SimEvent::Type::SoiExit, i, (uint32_t)parent, t, (float)m_Tree.Radii[parent]);
+		}
+
+		if (newParent >= 0 && boundary((uint32_t)newParent)(0.0) >= 0.0 && boundary((uint32_t)newParent)(1.0) < 0.0)
+		{
+			double t = Bisect(boundary((uint32_t)newParent));
+
+			Emit(SimEvent::Type::SoiEnter, i, (uint32_t)newParent, t, (float)m_Tree.Radii[newParent]);
+		}
+
+		m_CurrentSoi[i] = newParent;
+	}
+
+	m_Time += m_StepDuration;
+}
+
+void EventDetector::Skip(float timeScale)
+{
+	Reset();
+
+	m_StepDuration = (double)SimClock::TPS_STEP * timeScale;
+	m_Time += m_StepDuration;
+}
+
+void EventDetector::Reset()
+{
+	m_Tree = SoiTree{};
+	m_CurrentSoi.clear();
+	m_StepsSinceBuild = 0;
+}
+
+glm::dvec3 EventDetector::Interpolant::Position(size_t bodyIdx, double t) const
+{
+	glm::dvec3 p0 = Before->Positions[bodyIdx];
+	glm::dvec3 p1 = After->Positions[bodyIdx];
+	glm::dvec3 m0 = glm::dvec3(Before->Velocities[bodyIdx]) * StepLength;
+	glm::dvec3 m1 = glm::dvec3(After->Velocities[bodyIdx]) * StepLength;
+
+	double t2 = t * t;
+	double t3 = t2 * t;
+
+	return (2.0 * t3 - 3.0 * t2 + 1.0) * p0 + (t3 - 2.0 * t2 + t) * m0 + (-2.0 * t3 + 3.0 * t2) * p1 + (t3 - t2) * m1;
+}
+
+glm::dvec3 EventDetector::Interpolant::Velocity(size_t bodyIdx, double t) const
+{
+	glm::dvec3 p0 = Before->Positions[bodyIdx];
+	glm::dvec3 p1 = After->Positions[bodyIdx];
+	glm::dvec3 m0 = glm::dvec3(Before->Velocities[bodyIdx]) * StepLength;
+	glm::dvec3 m1 = glm::dvec3(After->Velocities[bodyIdx]) * StepLength;
+
+	double t2 = t * t;
+
+	// Derivative of the spline is in position per step, scaled back into velocity units
+	glm::dvec3 derivative = (6.0 * t2 - 6.0 * t) * p0 + (3.0 * t2 - 4.0 * t + 1.0) * m0 + (-6.0 * t2 + 6.0 * t) * p1 + (3.0 * t2 - 2.0 * t) * m1;
+
+	return StepLength > 0.0 ? derivative / StepLength : glm::dvec3(0.0);
+}
+
+double EventDetector::Bisect(const std::function<double(double)>& func) const
+{
+	double low = 0.0;
+	double high = 1.0;
+	bool lowNegative = func(low) < 0.0;
+
+	for (uint32_t i = 0; i < BISECTION_STEPS; i++)
+	{
+		double mid = 0.5 * (low + high);
+
+		if ((func(mid) < 0.0) == lowNegative)
+		{
+			low = mid;
+		}
+		else
+		{
+			high = mid;
+		}
+	}
+
+	return 0.5 * (low + high);
+}
+
+int32_t EventDetector::FindSoi(const BodyStore& bodies, uint32_t bodyIdx) const
+{
+	// Same rule the tree was built with, only against current positions and the radii from the last build
+	int32_t soi = -1;
+	double smallestRadius = HUGE_VAL;
+
+	for (uint32_t candidate : m_Tree.Order)
+	{
+		if (candidate == bodyIdx)
+		{
+			break;
+		}
+
+		if (bodies.Masses[candidate] <= 0.0f || m_Tree.Radii[candidate] >= smallestRadius
+			|| glm::distance(glm::dvec3(bodies.Positions[bodyIdx]), glm::dvec3(bodies.Positions[candidate])) >= m_Tree.Radii[candidate])
+		{
+			continue;
+		}
+
+		smallestRadius = m_Tree.Radii[candidate];
+		soi = (int32_t)candidate;
+	}
+
+	return soi;
+}
+
+void EventDetector::Emit(SimEvent::Type type, uint32_t body, uint32_t other, double stepFraction, float distance)
+{
+	SimEvent& ev = m_Events.emplace_back();
+	ev.EventType = type;
+	ev.Body = body;
+	ev.Other = other;
+	ev.Time = m_Time + stepFraction * m_StepDuration;
+	ev.Distance = distance;
+
+	m_Counts[(size_t)type]++;
+
+	if (m_Events.size() > MAX_EVENTS)
+	{
+		m_Events.pop_front();
+	}
+
+	if (LogEnabled)
+	{
+		LOG_INFO("{} of body {} and body {} at t = {:.6f}, distance {:.6f}", SimEventTypeName(type), body, other, ev.Time, distance);
+	}
+}
+
+void EventDetector::SaveState(StateWriter& writer) const
+{
+	writer.Write(CloseApproachDistance);
+	writer.WriteVector(m_Tree.Parents);
+	writer.WriteVector(m_Tree.Order);
+	writer.WriteVector(m_Tree.Radii);
+	writer.WriteVector(m_CurrentSoi);
+	writer.WriteVector(std::vector<SimEvent>(m_Events.begin(), m_Events.end()));
+	writer.Write(m_Counts);
+	writer.Write(m_Time);
+	writer.Write(m_StepDuration);
+	writer.Write(m_StepsSinceBuild);
+}
+
+bool EventDetector::LoadState(StateReader& reader)
+{
+	std::vector<SimEvent> events;
+
+	reader.Read(CloseApproachDistance);
+	reader.ReadVector(m_Tree.Parents);
+	reader.ReadVector(m_Tree.Order);
+	reader.ReadVector(m_Tree.Radii);
+	reader.ReadVector(m_CurrentSoi);
+	reader.ReadVector(events);
+	reader.Read(m_Counts);
+	reader.Read(m_Time);
+	reader.Read(m_StepDuration);
+	reader.Read(m_StepsSinceBuild);
+	m_Events.assign(events.begin(), events.end());
+
+	return !reader.Failed();
+}
\ No newline at end of file
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "BodyStore.hpp"
+#include "SoiTree.hpp"
+
+#include <glm/glm.hpp>
+
+#include <array>
+#include <deque>
+#include <functional>
+#include <vector>
+#include <cstdint>
+
+struct SimEvent
+{
+	enum class Type
+	{
+		CloseApproach,
+		Periapsis,
+		SoiEnter,
+		SoiExit
+	};
+
+	Type EventType = Type::CloseApproach;
+	uint32_t Body = 0;
+
+	// Other body of a close approach, the parent for periapsis and the sphere's owner for SOI changes
+	uint32_t Other = 0;
+
+	double Time = 0.0;
+	float Distance = 0.0f;
+};
+
+const char* SimEventTypeName(SimEvent::Type type);
+
+class StateWriter;
+class StateReader;
+
+// Finds events between two consecutive steps without shrinking the step. Every event is a sign change
+// of some function of the state, checked at both ends of the step first. Only bracketed sign changes
+// get bisected, on positions interpolated with cubic Hermite splines from the states and velocities at both ends.
+class EventDetector
+{
+public:
+	// before and after are the states around a step of timeScale, same bodies in the same order
+	void Detect(const BodyStore& before, const BodyStore& after, float timeScale);
+	// Step taken with detection off, it still moves the clock events are stamped with
+	void Skip(float timeScale);
+	void Reset();
+
+	// Everything the next steps depend on, for checkpoints. Loading fails on data written by anything else.
+	void SaveState(StateWriter& writer) const;
+	bool LoadState(StateReader& reader);
+
+	inline const std::deque<SimEvent>& GetEvents() const { return m_Events; }
+	inline double GetTime() const { return m_Time; }
+
+	// Every event of the type found so far, including the ones that fell out of GetEvents()
+	inline uint64_t GetCount(SimEvent::Type type) const { return m_Counts[(size_t)type]; }
+
+	// Only approaches closer than this get reported [distance units].
+	// Bodies are points here, there's no collision test against their radii, only this threshold.
+	float CloseApproachDistance = 2.0f;
+
+	bool LogEnabled = false;
+
+	inline static constexpr uint32_t MAX_EVENTS = 256;
+	inline static constexpr uint32_t SOI_REBUILD_INTERVAL = 240;
+	inline static constexpr uint32_t BISECTION_STEPS = 32;
+
+private:
+	struct Interpolant
+	{
+		const BodyStore* Before = nullptr;
+		const BodyStore* After = nullptr;
+		double StepLength = 0.0; // Position rate * step duration, scales velocities into the spline's tangents
+
+		glm::dvec3 Position(size_t bodyIdx, double t) const;
+		glm::dvec3 Velocity(size_t bodyIdx, double t) const;
+	};
+
+	// Returns the fraction of the step where func changes sign, assumes it does
+	double Bisect(const std::function<double(double)>& func) const;
+
+	int32_t FindSoi(const BodyStore& bodies, uint32_t bodyIdx) const;
+	void Emit(SimEvent::Type type, uint32_t body, uint32_t other, double stepFraction, float distance);
+
+	SoiTree m_Tree;
+	std::vector<int32_t> m_CurrentSoi;
+	std::deque<SimEvent> m_Events;
+	std::array<uint64_t, 4> m_Counts{};
+
+	double m_Time = 0.0;
+	double m_StepDuration = 0.0;
+	uint32_t m_StepsSinceBuild = 0;
+};
\ No newline at end of file
@@ -0,0 +1,219 @@
+#include "HierarchicalIntegrator.hpp"
+#include "../Simulator.hpp"
+#include "SimClock.hpp"
+#include "StateArchive.hpp"
+#include "../JobSystem.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+void HierarchicalIntegrator::Step(BodyStore& bodies, float timeScale, float gMultiplier, const std::vector<uint8_t>* skipMask)
+{
+	bool rebuild = m_LocalPositions.size() != bodies.Size() || m_StepsSinceBuild++ % REBUILD_INTERVAL == 0;
+
+	if (rebuild)
+	{
+		m_Tree.Build(bodies);
+		m_StepsSinceBuild = 1;
+	}
+
+	SyncLocalStates(bodies, rebuild);
+	m_SkipMask = skipMask;
+
+	const double K = (double)gMultiplier * SimPhysics::SCALE_FACTOR / SimPhysics::SUN_MASS;
+	const double c = (double)SimPhysics::VELOCITY_SCALE;
+	const double dt = (double)SimClock::TPS_STEP * timeScale;
+	const std::vector<glm::vec3>& positions = bodies.Positions;
+	const std::vector<float>& masses = bodies.Masses;
+	uint32_t count = (uint32_t)bodies.Size();
+
+	std::atomic<uint32_t> maxSubsteps = 1;
+
+	JobSystem::ParallelFor(0, count, SimPhysics::BODIES_PER_JOB, [&](uint32_t chunkBegin, uint32_t chunkEnd)
+		{
+			for (uint32_t i = chunkBegin; i < chunkEnd; i++)
+			{
+				if (masses[i] <= 0.0f || (skipMask && (*skipMask)[i]))
+				{
+					continue;
+				}
+
+				// Roots feel everything directly, children only what pulls them differently than their parent
+				int32_t parent = m_Tree.Parents[i];
+				glm::dvec3 accel(0.0);
+
+				for (uint32_t j = 0; j < count; j++)
+				{
+					if (j == i || (int32_t)j == parent || masses[j] <= 0.0f)
+					{
+						continue;
+					}
+
+					glm::dvec3 toOther = glm::dvec3(positions[j]) - glm::dvec3(positions[i]);
+					double distance = glm::length(toOther);
+
+					if (distance <= 0.0)
+					{
+						continue;
+					}
+
+					accel += K * masses[j] * toOther / (distance * distance * distance);
+
+					if (parent >= 0)
+					{
+						glm::dvec3 fromParent = glm::dvec3(positions[j]) - glm::dvec3(positions[parent]);
+						double parentDistance = glm::length(fromParent);
+
+						if (parentDistance > 0.0)
+						{
+							accel -= K * masses[j] * fromParent / (parentDistance * parentDistance * parentDistance);
+						}
+					}
+				}
+
+				glm::dvec3& position = m_LocalPositions[i];
+				glm::dvec3& velocity = m_LocalVelocities[i];
+
+				if (parent < 0)
+				{
+					velocity += dt * accel;
+					position += c * dt * velocity;
+
+					continue;
+				}
+
+				// Substeps follow the subsystem's own orbital period, taken from its two-body energy
+				double mu = K * ((double)masses[parent] + masses[i]);
+				double distance = glm::length(position);
+				double speed = glm::length(velocity) * c;
+				double energy = 0.5 * speed * speed - c * mu / distance;
+				uint32_t substeps = 1;
+
+				if (energy < 0.0 && distance > 0.0)
+				{
+					double semiMajorAxis = -c * mu / (2.0 * energy);
+					double period = 2.0 * glm::pi<double>() * std::sqrt(semiMajorAxis * semiMajorAxis * semiMajorAxis / (c * mu));
+
+					substeps = (uint32_t)std::clamp(std::ceil(dt * STEPS_PER_ORBIT / period), 1.0, (double)MAX_SUBSTEPS);
+				}
+
+				double h = dt / substeps;
+
+				for (uint32_t s = 0; s < substeps; s++)
+				{
+					double r = glm::length(position);
+					glm::dvec3 twoBody = r > 0.0 ? -mu * position / (r * r * r) : glm::dvec3(0.0);
+
+					velocity += h * (twoBody + accel);
+					position += c * h * velocity;
+				}
+
+				uint32_t seen = maxSubsteps.load();
+				while (substeps > seen && !maxSubsteps.compare_exchange_weak(seen, substeps));
+			}
+		});
+
+	m_MaxSubsteps = maxSubsteps;
+
+	// Massless bodies aren't pulled by anything, they just keep drifting
+	for (uint32_t i = 0; i < count; i++)
+	{
+		if (masses[i] <= 0.0f && !(skipMask && (*skipMask)[i]))
+		{
+			m_LocalPositions[i] += c * dt * m_LocalVelocities[i];
+		}
+	}
+
+	Reconstruct(bodies);
+}
+
+void HierarchicalIntegrator::Reconstruct(BodyStore& bodies)
+{
+	for (uint32_t i : m_Tree.Order)
+	{
+		int32_t parent = m_Tree.Parents[i];
+		glm::dvec3 parentPosition = parent < 0 ? glm::dvec3(0.0) : glm::dvec3(bodies.Positions[parent]);
+		glm::dvec3 parentVelocity = parent < 0 ? glm::dvec3(0.0) : glm::dvec3(bodies.Velocities[parent]);
+
+		if (m_SkipMask && (*m_SkipMask)[i])
+		{
+			// Somebody else owns this one, only its local state needs to follow
+			m_LocalPositions[i] = glm::dvec3(bodies.Positions[i]) - parentPosition;
+			m_LocalVelocities[i] = glm::dvec3(bodies.Velocities[i]) - parentVelocity;
+		}
+		else
+		{
+			bodies.Positions[i] = parentPosition + m_LocalPositions[i];
+			bodies.Velocities[i] = parentVelocity + m_LocalVelocities[i];
+		}
+
+		m_WrittenPositions[i] = bodies.Positions[i];
+		m_WrittenVelocities[i] = bodies.Velocities[i];
+	}
+}
+
+void HierarchicalIntegrator::Reset()
+{
+	m_Tree = SoiTree{};
+	m_LocalPositions.clear();
+	m_LocalVelocities.clear();
+	m_WrittenPositions.clear();
+	m_WrittenVelocities.clear();
+	m_SkipMask = nullptr;
+	m_StepsSinceBuild = 0;
+	m_MaxSubsteps = 0;
+}
+
+void HierarchicalIntegrator::SyncLocalStates(const BodyStore& bodies, bool force)
+{
+	size_t count = bodies.Size();
+
+	m_LocalPositions.resize(count);
+	m_LocalVelocities.resize(count);
+	m_WrittenPositions.resize(count);
+	m_WrittenVelocities.resize(count);
+
+	// Bodies that still sit where the last step put them keep their precise local state
+	for (uint32_t i : m_Tree.Order)
+	{
+		if (!force && bodies.Positions[i] == m_WrittenPositions[i] && bodies.Velocities[i] == m_WrittenVelocities[i])
+		{
+			continue;
+		}
+
+		int32_t parent = m_Tree.Parents[i];
+
+		m_LocalPositions[i] = glm::dvec3(bodies.Positions[i]) - (parent < 0 ? glm::dvec3(0.0) : glm::dvec3(bodies.Positions[parent]));
+		m_LocalVelocities[i] = glm::dvec3(bodies.Velocities[i]) - (parent < 0 ? glm::dvec3(0.0) : glm::dvec3(bodies.Velocities[parent]));
+	}
+}
+
+void HierarchicalIntegrator::SaveState(StateWriter& writer) const
+{
+	writer.WriteVector(m_Tree.Parents);
+	writer.WriteVector(m_Tree.Order);
+	writer.WriteVector(m_Tree.Radii);
+	writer.WriteVector(m_LocalPositions);
+	writer.WriteVector(m_LocalVelocities);
+	writer.WriteVector(m_WrittenPositions);
+	writer.WriteVector(m_WrittenVelocities);
+	writer.Write(m_StepsSinceBuild);
+	writer.Write(m_MaxSubsteps);
+}
+
+bool HierarchicalIntegrator::LoadState(StateReader& reader)
+{
+	reader.ReadVector(m_Tree.Parents);
+	reader.ReadVector(m_Tree.Order);
+	reader.ReadVector(m_Tree.Radii);
+	reader.ReadVector(m_LocalPositions);
+	reader.ReadVector(m_LocalVelocities);
+	reader.ReadVector(m_WrittenPositions);
+	reader.ReadVector(m_WrittenVelocities);
+	reader.Read(m_StepsSinceBuild);
+	reader.Read(m_MaxSubsteps);
+	m_SkipMask = nullptr;
+
+	return !reader.Failed();
+}
\ No newline at end of file
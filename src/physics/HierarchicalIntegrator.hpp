@@ -0,0 +1,60 @@
+#pragma once
+
+#include "BodyStore.hpp"
+#include "SoiTree.hpp"
+
+#include <glm/glm.hpp>
+
+#include <vector>
+#include <cstdint>
+
+class StateWriter;
+class StateReader;
+
+// Integrates every body relative to its sphere of influence parent instead of in absolute coordinates.
+// Local states live in doubles between steps, so moons don't lose precision to their planet's distance from the star.
+// The parent's pull is evaluated exactly every substep, everything else only once per step as a tidal perturbation,
+// which lets tight subsystems take several substeps while the rest of the system takes one.
+// Coordinates are parent-relative, not Jacobi ones measured from the barycentre of every body further in.
+// Jacobi coordinates would keep the indirect terms out of the split, here the pull of siblings and of whatever moves
+// the parent is held at its start-of-step value over all substeps, which makes it first order in the step.
+// That error is small while each sphere of influence is dominated by its parent, which is what the tree assumes anyway,
+// and it keeps the per-body work independent, so bodies still integrate in parallel.
+class HierarchicalIntegrator
+{
+public:
+	// Bodies flagged in skipMask are moved by someone else, call Reconstruct once they are
+	void Step(BodyStore& bodies, float timeScale, float gMultiplier, const std::vector<uint8_t>* skipMask = nullptr);
+
+	// Rebuilds absolute states top-down from local ones, keeping skipped bodies where they were put
+	void Reconstruct(BodyStore& bodies);
+
+	void Reset();
+
+	// Everything the next steps depend on, for checkpoints. Loading fails on data written by anything else.
+	void SaveState(StateWriter& writer) const;
+	bool LoadState(StateReader& reader);
+
+	inline const SoiTree& GetTree() const { return m_Tree; }
+	inline uint32_t GetMaxSubsteps() const { return m_MaxSubsteps; }
+
+	inline static constexpr uint32_t REBUILD_INTERVAL = 240;
+	inline static constexpr uint32_t STEPS_PER_ORBIT  = 256;
+	inline static constexpr uint32_t MAX_SUBSTEPS	  = 64;
+
+private:
+	void SyncLocalStates(const BodyStore& bodies, bool force);
+
+	SoiTree m_Tree;
+
+	std::vector<glm::dvec3> m_LocalPositions;
+	std::vector<glm::dvec3> m_LocalVelocities;
+
+	// What the last step handed out, anything different got edited or moved from outside
+	std::vector<glm::vec3> m_WrittenPositions;
+	std::vector<glm::vec3> m_WrittenVelocities;
+
+	const std::vector<uint8_t>* m_SkipMask = nullptr;
+	uint32_t m_StepsSinceBuild = 0;
+	uint32_t m_MaxSubsteps = 0;
+};
\ No newline at end of file
@@ -0,0 +1,83 @@
+#include "KeplerOrbit.hpp"
+
+#include <cmath>
+
+std::optional<KeplerOrbit> KeplerOrbit::FromState(const glm::dvec3& position, const glm::dvec3& rate, double mu, double maxEccentricity)
+{
+	double distance = glm::length(position);
+	glm::dvec3 momentum = glm::cross(position, rate);
+
+	if (distance <= 0.0 || mu <= 0.0 || glm::dot(momentum, momentum) <= 0.0)
+	{
+		return std::nullopt;
+	}
+
+	double energy = 0.5 * glm::dot(rate, rate) - mu / distance;
+
+	if (energy >= 0.0)
+	{
+		return std::nullopt;
+	}
+
+	glm::dvec3 eccentricityVec = glm::cross(rate, momentum) / mu - position / distance;
+	double eccentricity = glm::length(eccentricityVec);
+
+	if (eccentricity >= maxEccentricity)
+	{
+		return std::nullopt;
+	}
+
+	KeplerOrbit orbit;
+	orbit.m_Eccentricity = eccentricity;
+	orbit.m_SemiMajorAxis = -mu / (2.0 * energy);
+	orbit.m_SemiMinorAxis = orbit.m_SemiMajorAxis * std::sqrt(1.0 - eccentricity * eccentricity);
+	orbit.m_MeanMotion = std::sqrt(mu / (orbit.m_SemiMajorAxis * orbit.m_SemiMajorAxis * orbit.m_SemiMajorAxis));
+
+	// Periapsis direction is meaningless on a circle, any direction in the plane does
+	orbit.m_P = eccentricity > 1e-9 ? eccentricityVec / eccentricity : position / distance;
+	orbit.m_Q = glm::cross(glm::normalize(momentum), orbit.m_P);
+
+	// Perifocal coordinates give the eccentric anomaly without dividing by the eccentricity
+	double cosE = glm::dot(position, orbit.m_P) / orbit.m_SemiMajorAxis + eccentricity;
+	double sinE = glm::dot(position, orbit.m_Q) / orbit.m_SemiMinorAxis;
+	double eccentricAnomaly = std::atan2(sinE, cosE);
+
+	orbit.m_MeanAnomalyAtEpoch = eccentricAnomaly - eccentricity * std::sin(eccentricAnomaly);
+
+	return orbit;
+}
+
+void KeplerOrbit::Evaluate(double time, glm::dvec3& outPosition, glm::dvec3& outRate) const
+{
+	double meanAnomaly = m_MeanAnomalyAtEpoch + m_MeanMotion * time;
+	double eccentricAnomaly = SolveEccentricAnomaly(meanAnomaly, m_Eccentricity);
+	double cosE = std::cos(eccentricAnomaly);
+	double sinE = std::sin(eccentricAnomaly);
+	double anomalyRate = m_MeanMotion / (1.0 - m_Eccentricity * cosE);
+
+	outPosition = m_SemiMajorAxis * (cosE - m_Eccentricity) * m_P + m_SemiMinorAxis * sinE * m_Q;
+	outRate = -m_SemiMajorAxis * sinE * anomalyRate * m_P + m_SemiMinorAxis * cosE * anomalyRate * m_Q;
+}
+
+double KeplerOrbit::SolveEccentricAnomaly(double meanAnomaly, double eccentricity)
+{
+	constexpr double twoPi = 6.283185307179586;
+
+	meanAnomaly = std::fmod(meanAnomaly, twoPi);
+
+	// Starting guess good enough for moderate eccentricities to converge in a handful of steps
+	double E = meanAnomaly + eccentricity * std::sin(meanAnomaly);
+
+	for (int32_t i = 0; i < 16; i++)
+	{
+		double delta = (E - eccentricity * std::sin(E) - meanAnomaly) / (1.0 - eccentricity * std::cos(E));
+		E -= delta;
+
+		if (std::abs(delta) < 1e-12)
+		{
+			break;
+		}
+	}
+
+	return E;
+}
\ No newline at end of file
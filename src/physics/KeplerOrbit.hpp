@@ -0,0 +1,39 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <optional>
+#include <cstdint>
+
+// Closed elliptic two-body orbit around a point, kept as orbital elements and evaluated at any time.
+// Works with position rates, i.e. velocities already multiplied by SimPhysics::VELOCITY_SCALE.
+class KeplerOrbit
+{
+public:
+	// Empty when the state isn't on an ellipse with eccentricity below maxEccentricity
+	static std::optional<KeplerOrbit> FromState(const glm::dvec3& position, const glm::dvec3& rate, double mu, double maxEccentricity);
+
+	// Position and rate relative to the attractor, time since the state the orbit was built from
+	void Evaluate(double time, glm::dvec3& outPosition, glm::dvec3& outRate) const;
+
+	inline double GetEccentricity() const { return m_Eccentricity; }
+	inline double GetSemiMajorAxis() const { return m_SemiMajorAxis; }
+
+private:
+	KeplerOrbit() = default;
+
+	// Rails keep empty orbits around to read checkpointed ones into
+	friend class KeplerRails;
+
+	// Newton iterations on E - e * sin(E) = M
+	static double SolveEccentricAnomaly(double meanAnomaly, double eccentricity);
+
+	glm::dvec3 m_P = { 1.0, 0.0, 0.0 }; // Towards periapsis
+	glm::dvec3 m_Q = { 0.0, 1.0, 0.0 }; // 90 degrees ahead of it in the orbital plane
+
+	double m_SemiMajorAxis = 0.0;
+	double m_SemiMinorAxis = 0.0;
+	double m_Eccentricity = 0.0;
+	double m_MeanMotion = 0.0;
+	double m_MeanAnomalyAtEpoch = 0.0;
+};
\ No newline at end of file
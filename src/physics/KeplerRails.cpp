@@ -0,0 +1,257 @@
+#include "KeplerRails.hpp"
+#include "../Simulator.hpp"
+#include "SimClock.hpp"
+#include "StateArchive.hpp"
+
+#include <glm/gtx/norm.hpp>
+
+#include <cmath>
+
+void KeplerRails::BeforeStep(BodyStore& bodies, float gMultiplier)
+{
+	if (m_Rails.size() != bodies.Size())
+	{
+		Reset();
+		m_Rails.resize(bodies.Size());
+		m_Mask.resize(bodies.Size(), 0);
+	}
+
+	if (!Enabled)
+	{
+		// Rails keep velocities up to date every step, so dropping the flags is all it takes
+		if (m_OnRailsCount > 0)
+		{
+			Reset();
+			m_Rails.resize(bodies.Size());
+			m_Mask.resize(bodies.Size(), 0);
+		}
+
+		return;
+	}
+
+	if (m_StepsSinceEvaluation++ % EVALUATE_INTERVAL == 0)
+	{
+		Evaluate(bodies, gMultiplier);
+	}
+}
+
+void KeplerRails::AfterStep(BodyStore& bodies, float timeScale)
+{
+	if (m_OnRailsCount == 0)
+	{
+		return;
+	}
+
+	double dt = (double)SimClock::TPS_STEP * timeScale;
+
+	for (size_t i = 0; i < m_Rails.size(); i++)
+	{
+		Rail& rail = m_Rails[i];
+
+		if (!m_Mask[i])
+		{
+			continue;
+		}
+
+		glm::dvec3 position{};
+		glm::dvec3 rate{};
+
+		rail.Time += dt;
+		rail.Orbit->Evaluate(rail.Time, position, rate);
+
+		bodies.Positions[i]	 = bodies.Positions[rail.Attractor] + glm::vec3(position);
+		bodies.Velocities[i] = bodies.Velocities[rail.Attractor] + glm::vec3(rate / (double)SimPhysics::VELOCITY_SCALE);
+	}
+}
+
+void KeplerRails::Reset()
+{
+	m_Rails.clear();
+	m_Mask.clear();
+	m_StepsSinceEvaluation = 0;
+	m_OnRailsCount = 0;
+}
+
+void KeplerRails::Evaluate(BodyStore& bodies, float gMultiplier)
+{
+	// Acceleration felt by a body is K * m / r^2, position rate is VELOCITY_SCALE * velocity
+	double K = (double)gMultiplier * SimPhysics::SCALE_FACTOR / SimPhysics::SUN_MASS;
+	std::vector<uint8_t> isAttractor(bodies.Size(), 0);
+
+	for (size_t i = 0; i < m_Rails.size(); i++)
+	{
+		if (m_Mask[i])
+		{
+			isAttractor[m_Rails[i].Attractor] = 1;
+		}
+	}
+
+	for (size_t i = 0; i < bodies.Size(); i++)
+	{
+		if (bodies.Masses[i] <= 0.0f)
+		{
+			continue;
+		}
+
+		int32_t attractor = FindAttractor(bodies, i);
+		bool eligible = attractor >= 0 && !m_Mask[attractor] && !isAttractor[i] && bodies.Masses[attractor] > bodies.Masses[i];
+		double ratio = eligible ? TidalRatio(bodies, i, (size_t)attractor) : 0.0;
+		double limit = m_Mask[i] ? Threshold * HYSTERESIS : Threshold;
+
+		if (!eligible || ratio > limit || (m_Mask[i] && attractor != m_Rails[i].Attractor))
+		{
+			if (m_Mask[i])
+			{
+				isAttractor[m_Rails[i].Attractor] = 0;
+				Release(i);
+			}
+
+			continue;
+		}
+
+		// Rebuilt even for bodies already on rails, picks up changes of the gravity multiplier
+		glm::dvec3 relPosition = glm::dvec3(bodies.Positions[i]) - glm::dvec3(bodies.Positions[attractor]);
+		glm::dvec3 relRate = (glm::dvec3(bodies.Velocities[i]) - glm::dvec3(bodies.Velocities[attractor])) * (double)SimPhysics::VELOCITY_SCALE;
+		double mu = (double)SimPhysics::VELOCITY_SCALE * K * ((double)bodies.Masses[attractor] + bodies.Masses[i]);
+		std::optional<KeplerOrbit> orbit = KeplerOrbit::FromState(relPosition, relRate, mu, MAX_ECCENTRICITY);
+
+		if (!orbit.has_value())
+		{
+			if (m_Mask[i])
+			{
+				isAttractor[m_Rails[i].Attractor] = 0;
+				Release(i);
+			}
+
+			continue;
+		}
+
+		if (!m_Mask[i])
+		{
+			m_Mask[i] = 1;
+			m_OnRailsCount++;
+		}
+
+		m_Rails[i] = Rail{ orbit, attractor, 0.0 };
+		isAttractor[attractor] = 1;
+	}
+}
+
+int32_t KeplerRails::FindAttractor(const BodyStore& bodies, size_t bodyIdx) const
+{
+	int32_t attractor = -1;
+	double strongest = 0.0;
+
+	for (size_t j = 0; j < bodies.Size(); j++)
+	{
+		double distance2 = glm::distance2(bodies.Positions[bodyIdx], bodies.Positions[j]);
+
+		if (j == bodyIdx || bodies.Masses[j] <= 0.0f || distance2 <= 0.0)
+		{
+			continue;
+		}
+
+		double pull = (double)bodies.Masses[j] / distance2;
+
+		if (pull > strongest)
+		{
+			strongest = pull;
+			attractor = (int32_t)j;
+		}
+	}
+
+	return attractor;
+}
+
+double KeplerRails::TidalRatio(const BodyStore& bodies, size_t bodyIdx, size_t attractorIdx) const
+{
+	// Third bodies pulling the body and its attractor the same way don't bend the orbit, only the difference counts
+	glm::dvec3 bodyPos = bodies.Positions[bodyIdx];
+	glm::dvec3 attractorPos = bodies.Positions[attractorIdx];
+	glm::dvec3 tidal(0.0);
+
+	for (size_t j = 0; j < bodies.Size(); j++)
+	{
+		if (j == bodyIdx || j == attractorIdx || bodies.Masses[j] <= 0.0f)
+		{
+			continue;
+		}
+
+		glm::dvec3 otherPos = bodies.Positions[j];
+		glm::dvec3 toOtherFromBody = otherPos - bodyPos;
+		glm::dvec3 toOtherFromAttractor = otherPos - attractorPos;
+		double bodyDistance = glm::length(toOtherFromBody);
+		double attractorDistance = glm::length(toOtherFromAttractor);
+
+		if (bodyDistance <= 0.0 || attractorDistance <= 0.0)
+		{
+			return HUGE_VAL;
+		}
+
+		tidal += (double)bodies.Masses[j] * (toOtherFromBody / (bodyDistance * bodyDistance * bodyDistance)
+			- toOtherFromAttractor / (attractorDistance * attractorDistance * attractorDistance));
+	}
+
+	double distance2 = glm::distance2(bodyPos, attractorPos);
+	double mainPull = ((double)bodies.Masses[attractorIdx] + bodies.Masses[bodyIdx]) / distance2;
+
+	return glm::length(tidal) / mainPull;
+}
+
+void KeplerRails::Release(size_t bodyIdx)
+{
+	m_Mask[bodyIdx] = 0;
+	m_Rails[bodyIdx] = Rail{};
+	m_OnRailsCount--;
+}
+
+void KeplerRails::SaveState(StateWriter& writer) const
+{
+	writer.Write(Enabled);
+	writer.Write(Threshold);
+	writer.Write<uint64_t>(m_Rails.size());
+
+	for (const Rail& rail : m_Rails)
+	{
+		writer.Write<uint8_t>(rail.Orbit.has_value());
+		writer.Write(rail.Orbit.value_or(KeplerOrbit()));
+		writer.Write(rail.Attractor);
+		writer.Write(rail.Time);
+	}
+
+	writer.WriteVector(m_Mask);
+	writer.Write(m_StepsSinceEvaluation);
+	writer.Write(m_OnRailsCount);
+}
+
+bool KeplerRails::LoadState(StateReader& reader)
+{
+	uint64_t railCount = 0;
+
+	reader.Read(Enabled);
+	reader.Read(Threshold);
+	reader.Read(railCount);
+	m_Rails.assign(reader.Failed() ? 0 : railCount, Rail{});
+
+	for (Rail& rail : m_Rails)
+	{
+		uint8_t hasOrbit = 0;
+		KeplerOrbit orbit;
+
+		reader.Read(hasOrbit);
+		reader.Read(orbit);
+		reader.Read(rail.Attractor);
+		reader.Read(rail.Time);
+
+		if (hasOrbit)
+		{
+			rail.Orbit = orbit;
+		}
+	}
+
+	reader.ReadVector(m_Mask);
+	reader.Read(m_StepsSinceEvaluation);
+	reader.Read(m_OnRailsCount);
+
+	return !reader.Failed();
+}
\ No newline at end of file
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "BodyStore.hpp"
+#include "KeplerOrbit.hpp"
+
+#include <optional>
+#include <vector>
+#include <cstdint>
+
+class StateWriter;
+class StateReader;
+
+// Puts bodies that barely feel anything but their main attractor on analytic Kepler orbits around it.
+// Bodies on rails skip the force pass entirely but still pull on everything else,
+// and they go back to numerical integration as soon as the other bodies' tidal pull grows.
+class KeplerRails
+{
+public:
+	// Called around every integration step, with the step skipping bodies flagged in GetMask() in between.
+	// Orbits get fitted with the step's G multiplier.
+	void BeforeStep(BodyStore& bodies, float gMultiplier);
+	void AfterStep(BodyStore& bodies, float timeScale);
+
+	void Reset();
+
+	// Everything the next steps depend on, for checkpoints. Loading fails on data written by anything else.
+	void SaveState(StateWriter& writer) const;
+	bool LoadState(StateReader& reader);
+
+	inline const std::vector<uint8_t>& GetMask() const { return m_Mask; }
+	inline uint32_t GetOnRailsCount() const { return m_OnRailsCount; }
+
+	bool Enabled = false;
+
+	// Tidal pull of every other body relative to the attractor's own pull
+	float Threshold = 1e-4f;
+
+	inline static constexpr uint32_t EVALUATE_INTERVAL = 60;
+	inline static constexpr float	 HYSTERESIS = 4.0f;
+	inline static constexpr double	 MAX_ECCENTRICITY = 0.9;
+
+private:
+	struct Rail
+	{
+		std::optional<KeplerOrbit> Orbit;
+		int32_t Attractor = -1;
+		double Time = 0.0;
+	};
+
+	void Evaluate(BodyStore& bodies, float gMultiplier);
+	int32_t FindAttractor(const BodyStore& bodies, size_t bodyIdx) const;
+	double TidalRatio(const BodyStore& bodies, size_t bodyIdx, size_t attractorIdx) const;
+	void Release(size_t bodyIdx);
+
+	std::vector<Rail> m_Rails;
+	std::vector<uint8_t> m_Mask;
+
+	uint32_t m_StepsSinceEvaluation = 0;
+	uint32_t m_OnRailsCount = 0;
+};
\ No newline at end of file
@@ -0,0 +1,180 @@
+#include "PararealIntegrator.hpp"
+#include "../Simulator.hpp"
+#include "../JobSystem.hpp"
+#include "SimClock.hpp"
+
+#include <algorithm>
+
+PararealIntegrator::PararealIntegrator(const Spec& spec)
+	: m_Spec(spec)
+{
+}
+
+std::vector<glm::vec3> PararealIntegrator::Run(const BodyStore& start, uint32_t totalSteps, float timeScale, size_t targetIdx, int32_t parentIdx,
+	const PathSampler::Spec& sampling, const std::function<bool(void)>& isCancelled)
+{
+	uint32_t sliceCount = m_Spec.Slices != 0 ? m_Spec.Slices
+		: SimClock::DETERMINISTIC ? DETERMINISTIC_SLICES : JobSystem::GetWorkerCount() + 1;
+	sliceCount = std::clamp(sliceCount, 1u, std::max(totalSteps, 1u));
+
+	uint32_t fineSteps = (totalSteps + sliceCount - 1) / sliceCount;
+	uint32_t coarseSteps = std::max(fineSteps / std::max(m_Spec.CoarseRatio, 1u), 1u);
+	float coarseTimeScale = timeScale * (float)fineSteps / (float)coarseSteps;
+
+	PathSampler::Spec sliceSampling = sampling;
+	sliceSampling.MaxPoints = std::max(sampling.MaxPoints / sliceCount, 2u);
+
+	// Coarse integration of a whole slice from the given start, false when cancelled
+	auto coarse = [&](const BodyStore& from, BodyStore& outEnd)
+		{
+			outEnd = from;
+
+			for (uint32_t i = 0; i < coarseSteps; i++)
+			{
+				if (isCancelled && isCancelled())
+				{
+					return false;
+				}
+
+				SimPhysics::StepBodies(outEnd, coarseTimeScale);
+			}
+
+			return true;
+		};
+
+	auto pathPoint = [targetIdx, parentIdx](const BodyStore& bodies)
+		{
+			glm::vec3 point = bodies.Positions[targetIdx];
+
+			return parentIdx < 0 ? point : point - bodies.Positions[(size_t)parentIdx];
+		};
+
+	// sliceStarts[n] is where slice n begins, coarseEnds[n] the coarse guess of where it ends
+	std::vector<BodyStore> sliceStarts(sliceCount + 1);
+	std::vector<BodyStore> coarseEnds(sliceCount);
+	std::vector<BodyStore> fineEnds(sliceCount);
+	std::vector<std::vector<glm::vec3>> slicePaths(sliceCount);
+
+	sliceStarts[0] = start;
+
+	for (uint32_t n = 0; n < sliceCount; n++)
+	{
+		if (!coarse(sliceStarts[n], coarseEnds[n]))
+		{
+			return {};
+		}
+
+		sliceStarts[n + 1] = coarseEnds[n];
+	}
+
+	// Fine integration of slice n from the given start, false when cancelled
+	auto fine = [&](uint32_t n, BodyStore bodies)
+		{
+			uint32_t steps = std::min(fineSteps, totalSteps - std::min(totalSteps, n * fineSteps));
+
+			slicePaths[n].clear();
+			PathSampler sampler(slicePaths[n], sliceSampling);
+			sampler.Feed(pathPoint(bodies));
+
+			for (uint32_t i = 0; i < steps; i++)
+			{
+				if (isCancelled && isCancelled())
+				{
+					return false;
+				}
+
+				SimPhysics::StepBodies(bodies, timeScale);
+				sampler.Feed(pathPoint(bodies));
+			}
+
+			sampler.Finish();
+			fineEnds[n] = std::move(bodies);
+
+			return true;
+		};
+
+	// Every iteration only makes one more slice exact, so past half of them the serial fallback below is cheaper
+	uint32_t maxIterations = std::min(m_Spec.MaxIterations, std::max(sliceCount / 2, 1u));
+	bool converged = false;
+	m_IterationsUsed = 0;
+
+	for (uint32_t iteration = 0; iteration < maxIterations; iteration++)
+	{
+		m_IterationsUsed++;
+
+		// After k iterations the first k slices start exactly where the serial run would, so they're left alone
+		JobSystem::ParallelFor(iteration, sliceCount, 1, [&](uint32_t chunkBegin, uint32_t chunkEnd)
+			{
+				for (uint32_t n = chunkBegin; n < chunkEnd; n++)
+				{
+					if (!fine(n, sliceStarts[n]))
+					{
+						return;
+					}
+				}
+			});
+
+		if (isCancelled && isCancelled())
+		{
+			return {};
+		}
+
+		// Correction sweep: new start = coarse(new previous start) + fine(old previous start) - coarse(old previous start)
+		float maxChange = 0.0f;
+
+		for (uint32_t n = iteration; n < sliceCount; n++)
+		{
+			BodyStore coarseEnd;
+			BodyStore& next = sliceStarts[n + 1];
+
+			if (!coarse(sliceStarts[n], coarseEnd))
+			{
+				return {};
+			}
+
+			for (size_t i = 0; i < next.Size(); i++)
+			{
+				glm::vec3 corrected = coarseEnd.Positions[i] + fineEnds[n].Positions[i] - coarseEnds[n].Positions[i];
+
+				maxChange = std::max(maxChange, glm::length(corrected - next.Positions[i]));
+				next.Positions[i] = corrected;
+				next.Velocities[i] = coarseEnd.Velocities[i] + fineEnds[n].Velocities[i] - coarseEnds[n].Velocities[i];
+			}
+
+			coarseEnds[n] = std::move(coarseEnd);
+		}
+
+		if (maxChange < m_Spec.Tolerance)
+		{
+			converged = true;
+
+			break;
+		}
+	}
+
+	// Paths past the last exact slice came from starts that were still moving, stitching them would leave jumps.
+	// They get integrated serially instead, from the end of the last slice that is exact.
+	if (!converged)
+	{
+		for (uint32_t n = m_IterationsUsed; n < sliceCount; n++)
+		{
+			if (!fine(n, n == 0 ? start : fineEnds[n - 1]))
+			{
+				return {};
+			}
+		}
+	}
+
+	std::vector<glm::vec3> points;
+	points.reserve(sampling.MaxPoints);
+
+	for (uint32_t n = 0; n < sliceCount; n++)
+	{
+		// Every slice starts where the previous one ended, within Tolerance when converged, so the shared point is kept once
+		size_t skip = n == 0 || slicePaths[n].empty() ? 0 : 1;
+
+		points.insert(points.end(), slicePaths[n].begin() + skip, slicePaths[n].end());
+	}
+
+	return points;
+}
\ No newline at end of file
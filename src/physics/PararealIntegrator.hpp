@@ -0,0 +1,41 @@
+#pragma once
+
+#include "BodyStore.hpp"
+#include "PathSampler.hpp"
+
+#include <glm/glm.hpp>
+
+#include <functional>
+#include <vector>
+#include <cstdint>
+
+// Parallel-in-time integration of long predictions. The horizon is cut into slices, a coarse propagator
+// (the same integrator with steps CoarseRatio times longer) guesses where every slice starts, the fine propagator
+// refines all slices at once on the job system, and a serial correction sweep repeats until the slice starts settle.
+class PararealIntegrator
+{
+public:
+	struct Spec
+	{
+		uint32_t Slices = 0; // 0 = one per worker and one for the calling thread, DETERMINISTIC_SLICES in deterministic mode
+		uint32_t CoarseRatio = 16;
+		uint32_t MaxIterations = 8; // Never more than half the slices, whatever isn't converged by then runs serially
+		float Tolerance = 1e-4f;
+	};
+
+	PararealIntegrator(const Spec& spec);
+
+	// Integrates totalSteps steps and returns the path of targetIdx, relative to parentIdx unless it's negative.
+	// Empty result means the run was cancelled.
+	std::vector<glm::vec3> Run(const BodyStore& start, uint32_t totalSteps, float timeScale, size_t targetIdx, int32_t parentIdx,
+		const PathSampler::Spec& sampling = {}, const std::function<bool(void)>& isCancelled = {});
+
+	inline uint32_t GetIterationsUsed() const { return m_IterationsUsed; }
+
+	// Slice boundaries decide where the corrections land, so the path would change with the worker count otherwise
+	inline static constexpr uint32_t DETERMINISTIC_SLICES = 8;
+
+private:
+	Spec m_Spec;
+	uint32_t m_IterationsUsed = 0;
+};
\ No newline at end of file
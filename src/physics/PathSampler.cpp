@@ -0,0 +1,76 @@
+#include "PathSampler.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+PathSampler::PathSampler(std::vector<glm::vec3>& outPoints, const Spec& spec)
+	: m_Points(outPoints), m_Spec(spec)
+{
+}
+
+bool PathSampler::Feed(const glm::vec3& point)
+{
+	if (IsFull())
+	{
+		return false;
+	}
+
+	if (m_Points.empty())
+	{
+		m_Previous = point;
+
+		return Emit(point);
+	}
+
+	glm::vec3 segment = point - m_Previous;
+	float segmentLength = glm::length(segment);
+
+	if (segmentLength <= 0.0f)
+	{
+		return false;
+	}
+
+	glm::vec3 direction = segment / segmentLength;
+	bool emitted = false;
+
+	if (!m_HasStartDirection)
+	{
+		m_StartDirection = direction;
+		m_HasStartDirection = true;
+	}
+
+	float turn = std::acos(std::clamp(glm::dot(m_StartDirection, direction), -1.0f, 1.0f));
+	float arcLength = m_ArcLength + segmentLength;
+
+	// Chord of an arc of length L turning by theta deviates from it by about L * theta / 8
+	if (!m_PreviousEmitted && (turn > m_Spec.MaxAngle || arcLength * turn * 0.125f > m_Spec.MaxDistanceError))
+	{
+		emitted = Emit(m_Previous);
+		m_StartDirection = direction;
+		arcLength = segmentLength;
+	}
+
+	m_ArcLength = arcLength;
+	m_Previous = point;
+	m_PreviousEmitted = false;
+
+	return emitted;
+}
+
+bool PathSampler::Finish()
+{
+	if (m_PreviousEmitted || IsFull())
+	{
+		return false;
+	}
+
+	return Emit(m_Previous);
+}
+
+bool PathSampler::Emit(const glm::vec3& point)
+{
+	m_Points.push_back(point);
+	m_PreviousEmitted = true;
+
+	return true;
+}
\ No newline at end of file
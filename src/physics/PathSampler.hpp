@@ -0,0 +1,40 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <vector>
+#include <cstdint>
+
+// Thins a densely integrated path down to the points needed to draw it.
+// A point is kept once the path turned by more than MaxAngle since the last kept one,
+// or once the straight line between them would stray further than MaxDistanceError from the path.
+class PathSampler
+{
+public:
+	struct Spec
+	{
+		float MaxAngle = glm::radians(3.0f);
+		float MaxDistanceError = 0.02f;
+		uint32_t MaxPoints = 2048;
+	};
+
+	PathSampler(std::vector<glm::vec3>& outPoints, const Spec& spec);
+
+	// Both return true when a point got appended to the output
+	bool Feed(const glm::vec3& point);
+	bool Finish();
+
+	inline bool IsFull() const { return m_Points.size() >= m_Spec.MaxPoints; }
+
+private:
+	bool Emit(const glm::vec3& point);
+
+	std::vector<glm::vec3>& m_Points;
+	Spec m_Spec;
+
+	glm::vec3 m_Previous = { 0.0f, 0.0f, 0.0f };
+	glm::vec3 m_StartDirection = { 0.0f, 0.0f, 0.0f };
+	float m_ArcLength = 0.0f;
+	bool m_HasStartDirection = false;
+	bool m_PreviousEmitted = true;
+};
\ No newline at end of file
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <cstdint>
+
+// Fixed step the simulation advances by. The windowed application ticks at this rate, headless runs just loop over it.
+struct SimClock
+{
+	inline static constexpr uint32_t TPS = 240;
+	inline static constexpr float TPS_STEP = 1.0f / TPS;
+
+	// Simulated time per step relative to TPS_STEP, 1.0 makes a second of ticks simulate a day
+	inline static float TPS_MULTIPLIER = 1.0f;
+
+	// Makes results a function of the input alone. Stepping is always split and reduced in a fixed order,
+	// this additionally pins what would otherwise follow the worker count or the frame time.
+	inline static bool DETERMINISTIC = false;
+};
\ No newline at end of file
@@ -0,0 +1,57 @@
+#include "SoiTree.hpp"
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+void SoiTree::Build(const BodyStore& bodies)
+{
+	size_t count = bodies.Size();
+
+	Parents.assign(count, -1);
+	Radii.assign(count, 0.0);
+	Order.resize(count);
+	std::iota(Order.begin(), Order.end(), 0u);
+	std::stable_sort(Order.begin(), Order.end(), [&bodies](uint32_t lhs, uint32_t rhs) { return bodies.Masses[lhs] > bodies.Masses[rhs]; });
+
+	for (size_t i = 0; i < count; i++)
+	{
+		uint32_t body = Order[i];
+
+		if (bodies.Masses[body] <= 0.0f)
+		{
+			continue;
+		}
+
+		double smallestRadius = std::numeric_limits<double>::infinity();
+
+		for (size_t j = 0; j < i; j++)
+		{
+			uint32_t candidate = Order[j];
+
+			if (bodies.Masses[candidate] <= 0.0f || Radii[candidate] >= smallestRadius
+				|| glm::distance(glm::dvec3(bodies.Positions[body]), glm::dvec3(bodies.Positions[candidate])) >= Radii[candidate])
+			{
+				continue;
+			}
+
+			smallestRadius = Radii[candidate];
+			Parents[body] = (int32_t)candidate;
+		}
+
+		if (Parents[body] < 0)
+		{
+			Radii[body] = std::numeric_limits<double>::infinity();
+
+			continue;
+		}
+
+		uint32_t parent = (uint32_t)Parents[body];
+		double distance = glm::distance(glm::dvec3(bodies.Positions[body]), glm::dvec3(bodies.Positions[parent]));
+
+		Radii[body] = distance * std::pow((double)bodies.Masses[body] / bodies.Masses[parent], 0.4);
+	}
+}
\ No newline at end of file
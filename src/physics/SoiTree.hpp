@@ -0,0 +1,22 @@
+#pragma once
+
+#include "BodyStore.hpp"
+
+#include <vector>
+#include <cstdint>
+
+// Sphere of influence hierarchy: every body hangs under the smallest sphere of influence of a heavier body it's inside of.
+// Stars end up as roots, planets under stars and moons under planets.
+struct SoiTree
+{
+	// -1 for roots and massless bodies, which don't pull on anything
+	std::vector<int32_t> Parents;
+
+	// Heaviest first, so every parent comes before its children
+	std::vector<uint32_t> Order;
+
+	// Laplace sphere of influence, a * (m / M)^(2/5), infinite for roots
+	std::vector<double> Radii;
+
+	void Build(const BodyStore& bodies);
+};
\ No newline at end of file
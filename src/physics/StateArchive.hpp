@@ -0,0 +1,94 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+// Flat binary blob of plain values and vectors of them, in the machine's own layout.
+// Only meant for checkpoints and recordings read back by the same build, not for anything exchanged between machines.
+class StateWriter
+{
+public:
+	template<typename T>
+	void Write(const T& value)
+	{
+		static_assert(std::is_trivially_copyable_v<T>, "Only plain values can be written raw");
+
+		const uint8_t* bytes = (const uint8_t*)&value;
+		m_Data.insert(m_Data.end(), bytes, bytes + sizeof(T));
+	}
+
+	template<typename T>
+	void WriteVector(const std::vector<T>& values)
+	{
+		static_assert(std::is_trivially_copyable_v<T>, "Only plain values can be written raw");
+
+		Write<uint64_t>(values.size());
+
+		const uint8_t* bytes = (const uint8_t*)values.data();
+		m_Data.insert(m_Data.end(), bytes, bytes + values.size() * sizeof(T));
+	}
+
+	inline const std::vector<uint8_t>& GetData() const { return m_Data; }
+
+private:
+	std::vector<uint8_t> m_Data;
+};
+
+// Reads what StateWriter wrote, in the same order. Running out of data fails every read from then on.
+class StateReader
+{
+public:
+	StateReader(const uint8_t* data, size_t size)
+		: m_Data(data), m_Size(size)
+	{}
+
+	template<typename T>
+	bool Read(T& outValue)
+	{
+		static_assert(std::is_trivially_copyable_v<T>, "Only plain values can be read raw");
+
+		if (m_Failed || m_Offset + sizeof(T) > m_Size)
+		{
+			m_Failed = true;
+
+			return false;
+		}
+
+		std::memcpy(&outValue, m_Data + m_Offset, sizeof(T));
+		m_Offset += sizeof(T);
+
+		return true;
+	}
+
+	template<typename T>
+	bool ReadVector(std::vector<T>& outValues)
+	{
+		static_assert(std::is_trivially_copyable_v<T>, "Only plain values can be read raw");
+
+		uint64_t count = 0;
+
+		if (!Read(count) || count > (m_Size - m_Offset) / sizeof(T))
+		{
+			m_Failed = true;
+
+			return false;
+		}
+
+		outValues.resize(count);
+		std::memcpy(outValues.data(), m_Data + m_Offset, count * sizeof(T));
+		m_Offset += count * sizeof(T);
+
+		return true;
+	}
+
+	inline bool Failed() const { return m_Failed; }
+	inline size_t GetOffset() const { return m_Offset; }
+
+private:
+	const uint8_t* m_Data = nullptr;
+	size_t m_Size = 0;
+	size_t m_Offset = 0;
+	bool m_Failed = false;
+};
\ No newline at end of file
@@ -0,0 +1,148 @@
+#include "SystemIntegrator.hpp"
+#include "../Simulator.hpp"
+#include "StateArchive.hpp"
+
+void SystemIntegrator::Step(BodyStore& bodies, float timeScale)
+{
+	m_Removed.clear();
+	UpdateEjections(bodies);
+
+	m_Rails.BeforeStep(bodies, GMultiplier);
+
+	// Events are found by comparing both ends of the step, the copy is only paid for while detection is on
+	if (DetectEvents)
+	{
+		m_PreviousBodies = bodies;
+	}
+
+	ConservationStats stats;
+	ConservationStats* statsPtr = TrackConservation ? &stats : nullptr;
+
+	if (HierarchicalIntegration)
+	{
+		// Hierarchical pass doesn't see plain pairwise distances, it pays for a separate loop
+		if (statsPtr)
+		{
+			stats = SimPhysics::MeasureConservation(bodies, GMultiplier);
+		}
+
+		// Children of bodies on rails get placed around them again once the rails moved them
+		m_Hierarchy.Step(bodies, timeScale, GMultiplier, &m_Rails.GetMask());
+		m_Rails.AfterStep(bodies, timeScale);
+		m_Hierarchy.Reconstruct(bodies);
+	}
+	else
+	{
+		m_Hierarchy.Reset();
+		SimPhysics::AccelerateAll(bodies, timeScale, &m_Rails.GetMask(), statsPtr, &m_PairPotentials, GMultiplier);
+		SimPhysics::MoveAll(bodies, timeScale);
+		m_Rails.AfterStep(bodies, timeScale);
+	}
+
+	if (statsPtr)
+	{
+		m_Conservation.Record(stats);
+	}
+
+	if (DetectEvents)
+	{
+		m_Events.Detect(m_PreviousBodies, bodies, timeScale);
+	}
+	else
+	{
+		m_Events.Skip(timeScale);
+	}
+}
+
+void SystemIntegrator::Reset()
+{
+	m_Rails.Reset();
+	m_Hierarchy.Reset();
+	m_Conservation.Reset();
+	m_Events.Reset();
+	m_Ejection.Reset();
+	m_Removed.clear();
+}
+
+void SystemIntegrator::UpdateEjections(BodyStore& bodies)
+{
+	if (!m_Ejection.Enabled)
+	{
+		if (m_Ejection.GetDeactivatedCount() == 0)
+		{
+			return;
+		}
+
+		// Ballistic bodies get their masses back, nothing built on the smaller system holds anymore
+		m_Ejection.Restore(bodies);
+		m_Ejection.Reset();
+	}
+	else if (m_Ejection.Evaluate(bodies, GMultiplier))
+	{
+		if (m_Ejection.Mode == EjectionPolicy::Action::Remove)
+		{
+			RemoveDeactivated(bodies);
+		}
+	}
+	else
+	{
+		m_Ejection.Apply(bodies);
+
+		return;
+	}
+
+	// Sources of gravity changed, so did the orbits, the hierarchy and the conserved totals
+	m_Rails.Reset();
+	m_Hierarchy.Reset();
+	m_Conservation.Reset();
+	m_Events.Reset();
+	m_Ejection.Apply(bodies);
+}
+
+void SystemIntegrator::RemoveDeactivated(BodyStore& bodies)
+{
+	const std::vector<uint8_t>& mask = m_Ejection.GetMask();
+	size_t kept = 0;
+
+	for (size_t i = 0; i < bodies.Size(); i++)
+	{
+		if (mask[i])
+		{
+			m_Removed.push_back((uint32_t)i);
+
+			continue;
+		}
+
+		bodies.Positions[kept]	= bodies.Positions[i];
+		bodies.Velocities[kept] = bodies.Velocities[i];
+		bodies.Masses[kept]		= bodies.Masses[i];
+		kept++;
+	}
+
+	bodies.Resize(kept);
+	m_Ejection.DropDeactivated();
+}
+
+void SystemIntegrator::SaveState(StateWriter& writer) const
+{
+	writer.Write(HierarchicalIntegration);
+	writer.Write(TrackConservation);
+	writer.Write(DetectEvents);
+
+	m_Rails.SaveState(writer);
+	m_Hierarchy.SaveState(writer);
+	m_Conservation.SaveState(writer);
+	m_Events.SaveState(writer);
+	m_Ejection.SaveState(writer);
+}
+
+bool SystemIntegrator::LoadState(StateReader& reader)
+{
+	reader.Read(HierarchicalIntegration);
+	reader.Read(TrackConservation);
+	reader.Read(DetectEvents);
+	m_Removed.clear();
+
+	return m_Rails.LoadState(reader) && m_Hierarchy.LoadState(reader) && m_Conservation.LoadState(reader)
+		&& m_Events.LoadState(reader) && m_Ejection.LoadState(reader);
+}
\ No newline at end of file
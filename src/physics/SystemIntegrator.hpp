@@ -0,0 +1,61 @@
+#pragma once
+
+#include "BodyStore.hpp"
+#include "KeplerRails.hpp"
+#include "HierarchicalIntegrator.hpp"
+#include "Conservation.hpp"
+#include "EventDetector.hpp"
+#include "EjectionPolicy.hpp"
+
+#include <vector>
+#include <cstdint>
+
+class StateWriter;
+class StateReader;
+
+// Everything a step of the live simulation does to the bodies, with no scene around it.
+// The windowed simulation and headless runs both step through it, so they integrate exactly the same way.
+class SystemIntegrator
+{
+public:
+	// Bodies the ejection policy removes get erased from bodies, GetRemovedBodies() tells which ones
+	void Step(BodyStore& bodies, float timeScale);
+	void Reset();
+
+	// Settings and the state of every part, for checkpoints
+	void SaveState(StateWriter& writer) const;
+	bool LoadState(StateReader& reader);
+
+	inline KeplerRails& GetRails()					 { return m_Rails;		  }
+	inline HierarchicalIntegrator& GetHierarchy()	 { return m_Hierarchy;	  }
+	inline ConservationMonitor& GetConservation()	 { return m_Conservation; }
+	inline EventDetector& GetEvents()				 { return m_Events;		  }
+	inline EjectionPolicy& GetEjection()			 { return m_Ejection;	  }
+
+	inline const KeplerRails& GetRails() const		 { return m_Rails;		  }
+	inline const EjectionPolicy& GetEjection() const { return m_Ejection;	  }
+
+	// Indices from before the last step, ascending
+	inline const std::vector<uint32_t>& GetRemovedBodies() const { return m_Removed; }
+
+	bool HierarchicalIntegration = false;
+	bool TrackConservation = true;
+	bool DetectEvents = false;
+
+	// Steps pull with this instead of SimPhysics::G_CONSTANT_MULTIPLIER, so runs on workers can each have their own
+	float GMultiplier = 1.0f;
+
+private:
+	void UpdateEjections(BodyStore& bodies);
+	void RemoveDeactivated(BodyStore& bodies);
+
+	KeplerRails m_Rails;
+	HierarchicalIntegrator m_Hierarchy;
+	ConservationMonitor m_Conservation;
+	EventDetector m_Events;
+	EjectionPolicy m_Ejection;
+
+	BodyStore m_PreviousBodies;
+	std::vector<double> m_PairPotentials;
+	std::vector<uint32_t> m_Removed;
+};
\ No newline at end of file
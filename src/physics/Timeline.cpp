@@ -0,0 +1,264 @@
+#include "Timeline.hpp"
+#include "SystemIntegrator.hpp"
+#include "SimClock.hpp"
+#include "StateArchive.hpp"
+
+#include <algorithm>
+
+Timeline::~Timeline()
+{
+	Cancel();
+	JobSystem::Wait(m_Job);
+}
+
+void Timeline::Start(const BodyStore& bodies, const std::vector<uint32_t>& bodyIds, const SystemIntegrator& system)
+{
+	Cancel();
+
+	m_Keyframes.clear();
+	m_Runs.clear();
+	m_Step = 0;
+	m_Time = 0.0;
+	m_Interval = std::max(KeyframeInterval, 1u);
+	m_MemoryUsage = 0;
+	m_Masses = bodies.Masses;
+
+	AddKeyframe(bodies, bodyIds, system);
+}
+
+void Timeline::Record(const BodyStore& bodies, const std::vector<uint32_t>& bodyIds, const SystemIntegrator& system, float timeScale)
+{
+	StepSettings settings = ReadSettings(system);
+
+	if (m_Runs.empty() || m_Runs.back().TimeScale != timeScale || m_Runs.back().Settings != settings)
+	{
+		m_Runs.push_back({ m_Step, timeScale, settings });
+	}
+
+	const std::vector<uint32_t>& removed = system.GetRemovedBodies();
+
+	for (auto it = removed.rbegin(); it != removed.rend(); it++)
+	{
+		m_Masses.erase(m_Masses.begin() + *it);
+	}
+
+	m_Step++;
+	m_Time += (double)SimClock::TPS_STEP * timeScale;
+
+	if (m_Step % m_Interval == 0)
+	{
+		AddKeyframe(bodies, bodyIds, system);
+		Thin();
+	}
+	else if (GetMemoryUsage() > MemoryBudget)
+	{
+		// Governor may change the time scale every tick, so the runs can outgrow the budget between keyframes.
+		// Once only runs after the last keyframe are left to drop, a keyframe taken right away lets them go.
+		Thin();
+
+		if (GetMemoryUsage() > MemoryBudget && m_Runs.size() > 1)
+		{
+			AddKeyframe(bodies, bodyIds, system);
+			Thin();
+		}
+	}
+}
+
+void Timeline::Seek(double time)
+{
+	uint64_t generation = ++m_Generation;
+
+	if (m_Keyframes.empty())
+	{
+		return;
+	}
+
+	auto after = std::upper_bound(m_Keyframes.begin(), m_Keyframes.end(), time,
+		[](double value, const Keyframe& keyframe) { return value < keyframe.Time; });
+	const Keyframe& keyframe = after == m_Keyframes.begin() ? m_Keyframes.front() : *(after - 1);
+
+	// Worker gets its own copies, the live simulation keeps recording while it runs
+	auto firstRun = std::upper_bound(m_Runs.begin(), m_Runs.end(), keyframe.State.Step,
+		[](uint64_t value, const StepRun& run) { return value < run.FirstStep; });
+	std::vector<StepRun> runs(firstRun == m_Runs.begin() ? firstRun : firstRun - 1, m_Runs.end());
+
+	// Chained onto the previous seek, which bails out on the generation change, so waiting on m_Job covers every seek
+	m_Job = JobSystem::Submit([this, keyframe, runs = std::move(runs), endStep = m_Step, time, generation]()
+		{
+			Resimulate(keyframe, runs, endStep, time, generation);
+		}, { m_Job });
+}
+
+void Timeline::Cancel()
+{
+	++m_Generation;
+	delete m_Ready.exchange(nullptr);
+}
+
+bool Timeline::Poll(TrajectoryRecorder::Frame& outFrame)
+{
+	TrajectoryRecorder::Frame* result = m_Ready.exchange(nullptr);
+
+	if (result == nullptr)
+	{
+		return false;
+	}
+
+	outFrame = std::move(*result);
+	delete result;
+
+	return true;
+}
+
+Timeline::StepSettings Timeline::ReadSettings(const SystemIntegrator& system)
+{
+	StepSettings settings;
+	settings.GMultiplier = system.GMultiplier;
+	settings.Hierarchical = system.HierarchicalIntegration;
+	settings.Rails = system.GetRails().Enabled;
+	settings.RailsThreshold = system.GetRails().Threshold;
+	settings.Ejection = system.GetEjection().Enabled;
+	settings.EjectionMode = system.GetEjection().Mode;
+	settings.EjectionRadius = system.GetEjection().Radius;
+
+	return settings;
+}
+
+void Timeline::ApplySettings(const StepSettings& settings, SystemIntegrator& system)
+{
+	system.GMultiplier = settings.GMultiplier;
+	system.HierarchicalIntegration = settings.Hierarchical;
+	system.GetRails().Enabled = settings.Rails;
+	system.GetRails().Threshold = settings.RailsThreshold;
+	system.GetEjection().Enabled = settings.Ejection;
+	system.GetEjection().Mode = settings.EjectionMode;
+	system.GetEjection().Radius = settings.EjectionRadius;
+}
+
+size_t Timeline::KeyframeSize(const Keyframe& keyframe)
+{
+	const Checkpoint& state = keyframe.State;
+
+	return sizeof(Keyframe) + state.Bodies.Size() * (2 * sizeof(glm::vec3) + sizeof(float) + sizeof(uint32_t)) + state.IntegratorState.size();
+}
+
+void Timeline::AddKeyframe(const BodyStore& bodies, const std::vector<uint32_t>& bodyIds, const SystemIntegrator& system)
+{
+	Keyframe& keyframe = m_Keyframes.emplace_back();
+	keyframe.State = Checkpoint::Capture(bodies, bodyIds, system, m_Step);
+	keyframe.State.Bodies.Masses = m_Masses;
+	keyframe.Time = m_Time;
+
+	m_MemoryUsage += KeyframeSize(keyframe);
+}
+
+void Timeline::Thin()
+{
+	while (GetMemoryUsage() > MemoryBudget && m_Keyframes.size() > 1)
+	{
+		// Fewer keyframes don't make the runs any shorter
+		if (m_Keyframes.size() == 2 || m_MemoryUsage < m_Runs.size() * sizeof(StepRun))
+		{
+			DropOldestKeyframe();
+
+			continue;
+		}
+
+		m_Interval *= 2;
+
+		// First keyframe stays, it's the only way back to where the history starts
+		auto dropped = std::remove_if(m_Keyframes.begin() + 1, m_Keyframes.end(),
+			[this](const Keyframe& keyframe) { return keyframe.State.Step % m_Interval != 0; });
+		m_Keyframes.erase(dropped, m_Keyframes.end());
+
+		m_MemoryUsage = 0;
+
+		for (const Keyframe& keyframe : m_Keyframes)
+		{
+			m_MemoryUsage += KeyframeSize(keyframe);
+		}
+	}
+}
+
+void Timeline::DropOldestKeyframe()
+{
+	m_MemoryUsage -= KeyframeSize(m_Keyframes.front());
+	m_Keyframes.erase(m_Keyframes.begin());
+
+	// Run the new first keyframe started in stays, every one before it only led up to it
+	uint64_t firstStep = m_Keyframes.front().State.Step;
+	auto firstRun = std::upper_bound(m_Runs.begin(), m_Runs.end(), firstStep,
+		[](uint64_t value, const StepRun& run) { return value < run.FirstStep; });
+
+	m_Runs.erase(m_Runs.begin(), firstRun == m_Runs.begin() ? firstRun : firstRun - 1);
+}
+
+void Timeline::Resimulate(const Keyframe& keyframe, const std::vector<StepRun>& runs, uint64_t endStep, double target, uint64_t generation)
+{
+	SystemIntegrator system;
+	StateReader reader(keyframe.State.IntegratorState.data(), keyframe.State.IntegratorState.size());
+
+	if (!system.LoadState(reader))
+	{
+		return;
+	}
+
+	// Neither changes where the bodies go, both only cost time here
+	system.TrackConservation = false;
+	system.DetectEvents = false;
+
+	BodyStore bodies = keyframe.State.Bodies;
+	std::vector<float> masses = bodies.Masses;
+	std::vector<uint32_t> bodyIds = keyframe.State.BodyIds;
+	double time = keyframe.Time;
+	size_t run = 0;
+
+	for (uint64_t step = keyframe.State.Step; step < endStep; step++)
+	{
+		if (m_Generation.load() != generation)
+		{
+			return;
+		}
+
+		while (run + 1 < runs.size() && runs[run + 1].FirstStep <= step)
+		{
+			run++;
+		}
+
+		// Same sum the live timeline built, so the step that ended at the target is found exactly
+		double nextTime = time + (double)SimClock::TPS_STEP * runs[run].TimeScale;
+
+		if (nextTime > target)
+		{
+			break;
+		}
+
+		// Masses come back every step like they do from the planets
+		ApplySettings(runs[run].Settings, system);
+		bodies.Masses = masses;
+		system.Step(bodies, runs[run].TimeScale);
+
+		const std::vector<uint32_t>& removed = system.GetRemovedBodies();
+
+		for (auto it = removed.rbegin(); it != removed.rend(); it++)
+		{
+			bodyIds.erase(bodyIds.begin() + *it);
+			masses.erase(masses.begin() + *it);
+		}
+
+		time = nextTime;
+	}
+
+	if (m_Generation.load() != generation)
+	{
+		return;
+	}
+
+	TrajectoryRecorder::Frame* result = new TrajectoryRecorder::Frame();
+	result->Time = time;
+	result->BodyIds = std::move(bodyIds);
+	result->Positions = std::move(bodies.Positions);
+	result->Velocities = std::move(bodies.Velocities);
+
+	delete m_Ready.exchange(result);
+}
\ No newline at end of file
@@ -0,0 +1,102 @@
+#pragma once
+
+#include "Checkpoint.hpp"
+#include "EjectionPolicy.hpp"
+#include "TrajectoryRecorder.hpp"
+#include "../JobSystem.hpp"
+
+#include <atomic>
+#include <vector>
+#include <cstdint>
+
+class SystemIntegrator;
+
+// Seekable history of the live simulation without recording every step. Full states get kept every few steps,
+// seeking restores the newest one before the target and steps forward to it on a worker.
+// Time scale and integrator settings of every step are logged too, so the steps re-simulated are the ones that ran.
+// Once the keyframes outgrow the memory budget every other one gets dropped and the interval doubles.
+// When the logged runs are what outgrew it, the oldest keyframe goes together with the runs only it needed,
+// so the history then starts later instead of the budget being exceeded.
+class Timeline
+{
+public:
+	Timeline() = default;
+	~Timeline();
+
+	// Forgets everything, the given state becomes the first keyframe
+	void Start(const BodyStore& bodies, const std::vector<uint32_t>& bodyIds, const SystemIntegrator& system);
+
+	// After every step of the live simulation, with the state it ended in and the time scale it ran with
+	void Record(const BodyStore& bodies, const std::vector<uint32_t>& bodyIds, const SystemIntegrator& system, float timeScale);
+
+	// Re-simulates up to the last step ending at or before time, a newer seek cancels the one still running
+	void Seek(double time);
+	void Cancel();
+
+	// Moves the state the newest seek ended in into outFrame, returns false when it isn't done yet
+	bool Poll(TrajectoryRecorder::Frame& outFrame);
+
+	inline double GetStartTime() const { return m_Keyframes.empty() ? 0.0 : m_Keyframes.front().Time; }
+	inline double GetEndTime() const { return m_Time; }
+	inline size_t GetKeyframeCount() const { return m_Keyframes.size(); }
+	inline uint32_t GetInterval() const { return m_Interval; }
+	inline size_t GetMemoryUsage() const { return m_MemoryUsage + m_Runs.size() * sizeof(StepRun); }
+
+	// Steps between keyframes right after Start
+	uint32_t KeyframeInterval = 240;
+	size_t MemoryBudget = 128ull * 1024 * 1024;
+
+private:
+	// Everything the UI may change between two steps that changes what a step does
+	struct StepSettings
+	{
+		float GMultiplier = 1.0f;
+		bool Hierarchical = false;
+		bool Rails = false;
+		float RailsThreshold = 0.0f;
+		bool Ejection = false;
+		EjectionPolicy::Action EjectionMode = EjectionPolicy::Action::Ballistic;
+		float EjectionRadius = 0.0f;
+
+		bool operator==(const StepSettings& other) const = default;
+	};
+
+	// Steps from FirstStep up to the next run's all ran the same way
+	struct StepRun
+	{
+		uint64_t FirstStep = 0;
+		float TimeScale = 1.0f;
+		StepSettings Settings;
+	};
+
+	// Bodies hold the masses from outside a step, ballistic ones only lose theirs in the step's snapshot
+	struct Keyframe
+	{
+		Checkpoint State;
+		double Time = 0.0;
+	};
+
+	static StepSettings ReadSettings(const SystemIntegrator& system);
+	static void ApplySettings(const StepSettings& settings, SystemIntegrator& system);
+	static size_t KeyframeSize(const Keyframe& keyframe);
+
+	void AddKeyframe(const BodyStore& bodies, const std::vector<uint32_t>& bodyIds, const SystemIntegrator& system);
+	void Thin();
+	void DropOldestKeyframe();
+	void Resimulate(const Keyframe& keyframe, const std::vector<StepRun>& runs, uint64_t endStep, double target, uint64_t generation);
+
+	std::vector<Keyframe> m_Keyframes;
+	std::vector<StepRun> m_Runs;
+
+	uint64_t m_Step = 0;
+	double m_Time = 0.0;
+	uint32_t m_Interval = 240;
+	size_t m_MemoryUsage = 0;
+
+	// Live simulation takes the masses from the planets every step, the ejection policy zeroing some doesn't stick
+	std::vector<float> m_Masses;
+
+	std::atomic<uint64_t> m_Generation = 0;
+	std::atomic<TrajectoryRecorder::Frame*> m_Ready = nullptr;
+	JobHandle m_Job;
+};
\ No newline at end of file
@@ -0,0 +1,426 @@
+#include "TrajectoryCodec.hpp"
+#include "StateArchive.hpp"
+#include "../JobSystem.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cmath>
+#include <cstring>
+
+// Width byte of a component whose values didn't fit a residual and follow as raw floats instead
+static constexpr uint8_t RAW_COMPONENT = 0xFF;
+
+// Bigger residuals mean the body jumped, e.g. got teleported in the editor, storing it raw is cheaper then anyway
+static constexpr double MAX_RESIDUAL = (double)(1 << 30);
+
+// Position x, y, z and velocity x, y, z, each coded as its own stream
+static constexpr uint32_t COMPONENTS = 6;
+
+class BitPacker
+{
+public:
+	BitPacker(std::vector<uint8_t>& out)
+		: m_Out(out)
+	{}
+
+	void Write(uint32_t value, uint32_t width)
+	{
+		m_Bits |= (uint64_t)value << m_Count;
+		m_Count += width;
+
+		while (m_Count >= 8)
+		{
+			m_Out.push_back((uint8_t)m_Bits);
+			m_Bits >>= 8;
+			m_Count -= 8;
+		}
+	}
+
+	void Flush()
+	{
+		if (m_Count > 0)
+		{
+			m_Out.push_back((uint8_t)m_Bits);
+		}
+
+		m_Bits = 0;
+		m_Count = 0;
+	}
+
+private:
+	std::vector<uint8_t>& m_Out;
+	uint64_t m_Bits = 0;
+	uint32_t m_Count = 0;
+};
+
+class BitUnpacker
+{
+public:
+	BitUnpacker(const uint8_t* data, size_t size)
+		: m_Data(data), m_Size(size)
+	{}
+
+	uint32_t Read(uint32_t width)
+	{
+		while (m_Count < width)
+		{
+			if (m_Offset >= m_Size)
+			{
+				m_Failed = true;
+
+				return 0;
+			}
+
+			m_Bits |= (uint64_t)m_Data[m_Offset++] << m_Count;
+			m_Count += 8;
+		}
+
+		uint32_t value = (uint32_t)(m_Bits & ((1ull << width) - 1));
+		m_Bits >>= width;
+		m_Count -= width;
+
+		return value;
+	}
+
+	uint8_t ReadByte()
+	{
+		Align();
+
+		if (m_Offset >= m_Size)
+		{
+			m_Failed = true;
+
+			return 0;
+		}
+
+		return m_Data[m_Offset++];
+	}
+
+	float ReadFloat()
+	{
+		Align();
+
+		if (m_Offset + sizeof(float) > m_Size)
+		{
+			m_Failed = true;
+
+			return 0.0f;
+		}
+
+		float value = 0.0f;
+		memcpy(&value, m_Data + m_Offset, sizeof(float));
+		m_Offset += sizeof(float);
+
+		return value;
+	}
+
+	// Drops what's left of the current byte, every stream starts on a byte boundary
+	void Align()
+	{
+		m_Bits = 0;
+		m_Count = 0;
+	}
+
+	inline bool Failed() const { return m_Failed; }
+
+private:
+	const uint8_t* m_Data = nullptr;
+	size_t m_Size = 0;
+	size_t m_Offset = 0;
+	uint64_t m_Bits = 0;
+	uint32_t m_Count = 0;
+	bool m_Failed = false;
+};
+
+static void WriteFloat(std::vector<uint8_t>& out, float value)
+{
+	uint8_t bytes[sizeof(float)];
+	memcpy(bytes, &value, sizeof(float));
+	out.insert(out.end(), bytes, bytes + sizeof(float));
+}
+
+// How far the frame is from the one before, in units of the gap between the two before it.
+// Recordings skip ticks and the time scale changes, so frames aren't evenly spaced.
+static float FrameRatio(const std::vector<double>& times, size_t frame)
+{
+	if (frame < 2)
+	{
+		return 0.0f;
+	}
+
+	double gap = times[frame - 1] - times[frame - 2];
+
+	return gap > 0.0 ? (float)((times[frame] - times[frame - 1]) / gap) : 1.0f;
+}
+
+// Encoder and decoder both go through these, so they predict and reconstruct exactly the same values
+static float Predict(float previous, float beforePrevious, float ratio)
+{
+	return previous + (previous - beforePrevious) * ratio;
+}
+
+static float Reconstruct(float predicted, int32_t residual, float step)
+{
+	return predicted + (float)residual * step;
+}
+
+// Keeps small negative residuals small
+static uint32_t ZigZag(int32_t value)
+{
+	return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+}
+
+static int32_t UnZigZag(uint32_t value)
+{
+	return (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+}
+
+static float ComponentOf(const TrajectoryChunk& chunk, size_t frame, size_t body, uint32_t component)
+{
+	const glm::vec3& value = component < 3 ? chunk.Positions[frame * chunk.GetBodyCount() + body]
+		: chunk.Velocities[frame * chunk.GetBodyCount() + body];
+
+	return value[component % 3];
+}
+
+static void SetComponent(TrajectoryChunk& chunk, size_t frame, size_t body, uint32_t component, float value)
+{
+	glm::vec3& target = component < 3 ? chunk.Positions[frame * chunk.GetBodyCount() + body]
+		: chunk.Velocities[frame * chunk.GetBodyCount() + body];
+
+	target[component % 3] = value;
+}
+
+static void EncodeBlock(const TrajectoryChunk& chunk, size_t begin, size_t end, float positionStep, float velocityStep, std::vector<uint8_t>& out)
+{
+	size_t count = end - begin;
+
+	// Decoded values of the two frames before, [component * count + body]
+	std::vector<float> previous(COMPONENTS * count);
+	std::vector<float> beforePrevious(COMPONENTS * count);
+	std::vector<float> predictions(count);
+	std::vector<int32_t> residuals(count);
+
+	for (uint32_t c = 0; c < COMPONENTS; c++)
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			float value = ComponentOf(chunk, 0, begin + i, c);
+
+			previous[c * count + i] = value;
+			WriteFloat(out, value);
+		}
+	}
+
+	for (size_t frame = 1; frame < chunk.GetFrameCount(); frame++)
+	{
+		float ratio = FrameRatio(chunk.Times, frame);
+
+		for (uint32_t c = 0; c < COMPONENTS; c++)
+		{
+			float step = c < 3 ? positionStep : velocityStep;
+			float* last = &previous[c * count];
+			float* beforeLast = &beforePrevious[c * count];
+			uint32_t widest = 0;
+			bool raw = false;
+
+			for (size_t i = 0; i < count && !raw; i++)
+			{
+				predictions[i] = frame == 1 ? last[i] : Predict(last[i], beforeLast[i], ratio);
+				double residual = std::round(((double)ComponentOf(chunk, frame, begin + i, c) - predictions[i]) / step);
+
+				// Also catches NaNs, which fail every comparison
+				raw = !(std::abs(residual) < MAX_RESIDUAL);
+				residuals[i] = raw ? 0 : (int32_t)residual;
+				widest |= ZigZag(residuals[i]);
+			}
+
+			uint32_t width = raw ? 0 : (uint32_t)std::bit_width(widest);
+			out.push_back(raw ? RAW_COMPONENT : (uint8_t)width);
+
+			BitPacker packer(out);
+
+			for (size_t i = 0; i < count; i++)
+			{
+				float decoded = 0.0f;
+
+				if (raw)
+				{
+					decoded = ComponentOf(chunk, frame, begin + i, c);
+					WriteFloat(out, decoded);
+				}
+				else
+				{
+					packer.Write(ZigZag(residuals[i]), width);
+					decoded = Reconstruct(predictions[i], residuals[i], step);
+				}
+
+				beforeLast[i] = last[i];
+				last[i] = decoded;
+			}
+
+			packer.Flush();
+		}
+	}
+}
+
+static bool DecodeBlock(const uint8_t* data, size_t size, size_t begin, size_t end, float positionStep, float velocityStep, TrajectoryChunk& chunk)
+{
+	size_t count = end - begin;
+	BitUnpacker unpacker(data, size);
+
+	std::vector<float> previous(COMPONENTS * count);
+	std::vector<float> beforePrevious(COMPONENTS * count);
+
+	for (uint32_t c = 0; c < COMPONENTS; c++)
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			float value = unpacker.ReadFloat();
+
+			previous[c * count + i] = value;
+			SetComponent(chunk, 0, begin + i, c, value);
+		}
+	}
+
+	for (size_t frame = 1; frame < chunk.GetFrameCount(); frame++)
+	{
+		float ratio = FrameRatio(chunk.Times, frame);
+
+		for (uint32_t c = 0; c < COMPONENTS; c++)
+		{
+			float step = c < 3 ? positionStep : velocityStep;
+			float* last = &previous[c * count];
+			float* beforeLast = &beforePrevious[c * count];
+			uint8_t width = unpacker.ReadByte();
+
+			if (width != RAW_COMPONENT && width > 32)
+			{
+				return false;
+			}
+
+			for (size_t i = 0; i < count; i++)
+			{
+				float decoded = 0.0f;
+
+				if (width == RAW_COMPONENT)
+				{
+					decoded = unpacker.ReadFloat();
+				}
+				else
+				{
+					float predicted = frame == 1 ? last[i] : Predict(last[i], beforeLast[i], ratio);
+
+					decoded = Reconstruct(predicted, UnZigZag(unpacker.Read(width)), step);
+				}
+
+				beforeLast[i] = last[i];
+				last[i] = decoded;
+				SetComponent(chunk, frame, begin + i, c, decoded);
+			}
+		}
+	}
+
+	return !unpacker.Failed();
+}
+
+void TrajectoryCodec::Encode(const TrajectoryChunk& chunk, const Spec& spec, std::vector<uint8_t>& outData)
+{
+	uint32_t bodiesPerBlock = std::max(spec.BodiesPerBlock, 1u);
+	uint32_t bodyCount = (uint32_t)chunk.GetBodyCount();
+	uint32_t blockCount = (bodyCount + bodiesPerBlock - 1) / bodiesPerBlock;
+	float positionStep = 2.0f * spec.PositionError;
+	float velocityStep = 2.0f * spec.VelocityError;
+
+	std::vector<std::vector<uint8_t>> blocks(blockCount);
+
+	JobSystem::ParallelFor(0, blockCount, 1, [&](uint32_t chunkBegin, uint32_t chunkEnd)
+		{
+			for (uint32_t block = chunkBegin; block < chunkEnd; block++)
+			{
+				size_t begin = (size_t)block * bodiesPerBlock;
+
+				EncodeBlock(chunk, begin, std::min<size_t>(begin + bodiesPerBlock, bodyCount), positionStep, velocityStep, blocks[block]);
+			}
+		});
+
+	std::vector<uint64_t> blockSizes(blockCount);
+
+	for (uint32_t block = 0; block < blockCount; block++)
+	{
+		blockSizes[block] = blocks[block].size();
+	}
+
+	StateWriter writer;
+	writer.Write(bodiesPerBlock);
+	writer.Write(positionStep);
+	writer.Write(velocityStep);
+	writer.WriteVector(chunk.Times);
+	writer.WriteVector(chunk.BodyIds);
+	writer.WriteVector(blockSizes);
+
+	outData = writer.GetData();
+
+	for (const std::vector<uint8_t>& block : blocks)
+	{
+		outData.insert(outData.end(), block.begin(), block.end());
+	}
+}
+
+bool TrajectoryCodec::Decode(const uint8_t* data, size_t size, TrajectoryChunk& outChunk)
+{
+	StateReader reader(data, size);
+	uint32_t bodiesPerBlock = 0;
+	float positionStep = 0.0f;
+	float velocityStep = 0.0f;
+	std::vector<uint64_t> blockSizes;
+
+	reader.Read(bodiesPerBlock);
+	reader.Read(positionStep);
+	reader.Read(velocityStep);
+	reader.ReadVector(outChunk.Times);
+	reader.ReadVector(outChunk.BodyIds);
+	reader.ReadVector(blockSizes);
+
+	uint64_t bodyCount = outChunk.GetBodyCount();
+
+	if (reader.Failed() || bodiesPerBlock == 0 || blockSizes.size() != (bodyCount + bodiesPerBlock - 1) / bodiesPerBlock)
+	{
+		return false;
+	}
+
+	// Offsets of every block, so they can be decoded in any order
+	std::vector<size_t> offsets(blockSizes.size() + 1, reader.GetOffset());
+
+	for (size_t block = 0; block < blockSizes.size(); block++)
+	{
+		offsets[block + 1] = offsets[block] + blockSizes[block];
+	}
+
+	if (offsets.back() > size)
+	{
+		return false;
+	}
+
+	outChunk.Positions.resize(outChunk.GetFrameCount() * bodyCount);
+	outChunk.Velocities.resize(outChunk.GetFrameCount() * bodyCount);
+
+	std::atomic<bool> failed = false;
+
+	JobSystem::ParallelFor(0, (uint32_t)blockSizes.size(), 1, [&](uint32_t chunkBegin, uint32_t chunkEnd)
+		{
+			for (uint32_t block = chunkBegin; block < chunkEnd; block++)
+			{
+				size_t begin = (size_t)block * bodiesPerBlock;
+				size_t end = std::min<size_t>(begin + bodiesPerBlock, bodyCount);
+
+				if (!DecodeBlock(data + offsets[block], blockSizes[block], begin, end, positionStep, velocityStep, outChunk))
+				{
+					failed = true;
+				}
+			}
+		});
+
+	return !failed;
+}
\ No newline at end of file
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <vector>
+#include <cstdint>
+
+// Run of consecutive frames of the same bodies, arrays are indexed [frame * bodyCount + body]
+struct TrajectoryChunk
+{
+	std::vector<double> Times;
+	std::vector<uint32_t> BodyIds;
+	std::vector<glm::vec3> Positions;
+	std::vector<glm::vec3> Velocities;
+
+	inline size_t GetFrameCount() const { return Times.size(); }
+	inline size_t GetBodyCount() const { return BodyIds.size(); }
+
+	void Clear()
+	{
+		Times.clear();
+		BodyIds.clear();
+		Positions.clear();
+		Velocities.clear();
+	}
+};
+
+// Lossy compression of trajectory chunks. The first frame is stored as is, every later one only as the difference
+// to a linear extrapolation of the two frames before it, quantized to a step of twice the allowed error and bit-packed
+// with as few bits as the biggest difference of each component needs. Smooth motion extrapolates well, so most
+// differences are a handful of bits or none at all.
+// Bodies are split into blocks encoded independently of each other, on the job system for big chunks.
+class TrajectoryCodec
+{
+public:
+	struct Spec
+	{
+		// Biggest difference between a stored and a decoded value, per component
+		float PositionError = 1e-3f;
+		float VelocityError = 1e-4f;
+
+		uint32_t BodiesPerBlock = 1024;
+	};
+
+	static void Encode(const TrajectoryChunk& chunk, const Spec& spec, std::vector<uint8_t>& outData);
+
+	// Returns false on truncated or corrupted data, outChunk is left in an unspecified state then
+	static bool Decode(const uint8_t* data, size_t size, TrajectoryChunk& outChunk);
+
+private:
+	TrajectoryCodec() = default;
+};
\ No newline at end of file
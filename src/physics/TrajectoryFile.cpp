@@ -0,0 +1,249 @@
+#include "TrajectoryFile.hpp"
+#include "StateArchive.hpp"
+#include "../Logger.hpp"
+
+#include <algorithm>
+#include <memory>
+#include <cstring>
+
+static constexpr char MAGIC[] = "SSSTRJZ";
+
+TrajectoryWriter::~TrajectoryWriter()
+{
+	Close();
+}
+
+bool TrajectoryWriter::Open(const std::string& path, const TrajectoryCodec::Spec& spec)
+{
+	Close();
+
+	m_File.open(path, std::ios::out | std::ios::binary | std::ios::trunc);
+
+	if (!m_File.good())
+	{
+		LOG_ERROR("Trajectory file {} could not be created.", path);
+
+		return false;
+	}
+
+	m_File.write(MAGIC, sizeof(MAGIC));
+	m_File.write((const char*)&VERSION, sizeof(VERSION));
+
+	m_Spec = spec;
+	m_Chunk.Clear();
+	m_FrameCount = 0;
+	m_RawBytes = 0;
+	m_WrittenBytes = sizeof(MAGIC) + sizeof(VERSION);
+
+	return true;
+}
+
+void TrajectoryWriter::Close()
+{
+	if (!IsOpen())
+	{
+		return;
+	}
+
+	SubmitChunk();
+
+	for (const JobHandle& job : m_Pending)
+	{
+		JobSystem::Wait(job);
+	}
+
+	m_Pending.clear();
+
+	if (!m_File.good())
+	{
+		LOG_ERROR("Trajectory file could not be written completely.");
+	}
+
+	m_File.close();
+}
+
+void TrajectoryWriter::Append(const std::vector<uint32_t>& bodyIds, const std::vector<glm::vec3>& positions, const std::vector<glm::vec3>& velocities, double time)
+{
+	if (!IsOpen())
+	{
+		return;
+	}
+
+	// A chunk holds the same bodies in every frame, a removed one starts a new chunk
+	if (m_Chunk.GetFrameCount() >= FramesPerChunk || (m_Chunk.GetFrameCount() > 0 && m_Chunk.BodyIds != bodyIds))
+	{
+		SubmitChunk();
+	}
+
+	if (m_Chunk.GetFrameCount() == 0)
+	{
+		m_Chunk.BodyIds = bodyIds;
+	}
+
+	m_Chunk.Times.push_back(time);
+	m_Chunk.Positions.insert(m_Chunk.Positions.end(), positions.begin(), positions.begin() + bodyIds.size());
+	m_Chunk.Velocities.insert(m_Chunk.Velocities.end(), velocities.begin(), velocities.begin() + bodyIds.size());
+
+	m_FrameCount++;
+	m_RawBytes += sizeof(double) + bodyIds.size() * 2 * sizeof(glm::vec3);
+}
+
+void TrajectoryWriter::SubmitChunk()
+{
+	if (m_Chunk.GetFrameCount() == 0)
+	{
+		return;
+	}
+
+	while (!m_Pending.empty() && (m_Pending.size() >= MAX_PENDING_CHUNKS || JobSystem::IsDone(m_Pending.front())))
+	{
+		JobSystem::Wait(m_Pending.front());
+		m_Pending.pop_front();
+	}
+
+	// Chunks encode in parallel with each other, only the writes are chained
+	std::shared_ptr<std::vector<uint8_t>> encoded = std::make_shared<std::vector<uint8_t>>();
+
+	JobHandle encode = JobSystem::Submit([chunk = std::move(m_Chunk), spec = m_Spec, encoded]()
+		{
+			TrajectoryCodec::Encode(chunk, spec, *encoded);
+		});
+
+	std::vector<JobHandle> dependencies = { encode };
+
+	if (!m_Pending.empty())
+	{
+		dependencies.push_back(m_Pending.back());
+	}
+
+	m_Pending.push_back(JobSystem::Submit([this, encoded]()
+		{
+			uint64_t size = encoded->size();
+
+			m_File.write((const char*)&size, sizeof(size));
+			m_File.write((const char*)encoded->data(), size);
+			m_WrittenBytes += sizeof(size) + size;
+		}, dependencies));
+
+	m_Chunk.Clear();
+}
+
+bool TrajectoryReader::Open(const std::string& path)
+{
+	Close();
+
+	if (!m_File.Open(path, MappedFile::Access::Read))
+	{
+		return false;
+	}
+
+	const uint8_t* data = m_File.GetData();
+	size_t size = m_File.GetSize();
+	int32_t version = 0;
+
+	if (size < sizeof(MAGIC) + sizeof(version) || memcmp(data, MAGIC, sizeof(MAGIC)) != 0)
+	{
+		LOG_ERROR("{} is not a trajectory file.", path);
+		Close();
+
+		return false;
+	}
+
+	memcpy(&version, data + sizeof(MAGIC), sizeof(version));
+
+	if (version != TrajectoryWriter::VERSION)
+	{
+		LOG_ERROR("Trajectory file {} is of version {}, expected {}.", path, version, TrajectoryWriter::VERSION);
+		Close();
+
+		return false;
+	}
+
+	size_t offset = sizeof(MAGIC) + sizeof(version);
+
+	while (offset + sizeof(uint64_t) <= size)
+	{
+		uint64_t chunkSize = 0;
+		memcpy(&chunkSize, data + offset, sizeof(chunkSize));
+		offset += sizeof(chunkSize);
+
+		// Header of the chunk has its frame times, nothing past it gets touched until a frame is asked for
+		StateReader reader(data + offset, std::min<size_t>(chunkSize, size - offset));
+		uint32_t bodiesPerBlock = 0;
+		float positionStep = 0.0f;
+		float velocityStep = 0.0f;
+		std::vector<double> times;
+
+		reader.Read(bodiesPerBlock);
+		reader.Read(positionStep);
+		reader.Read(velocityStep);
+		reader.ReadVector(times);
+
+		// Recording that got cut off, everything up to the last complete chunk is still good
+		if (reader.Failed() || chunkSize > size - offset)
+		{
+			LOG_WARN("Trajectory file {} ends in a truncated chunk, it's left out.", path);
+
+			break;
+		}
+
+		m_Chunks.push_back({ offset, chunkSize, m_Times.size() });
+		m_Times.insert(m_Times.end(), times.begin(), times.end());
+		offset += chunkSize;
+	}
+
+	return true;
+}
+
+void TrajectoryReader::Close()
+{
+	m_File.Close();
+	m_Chunks.clear();
+	m_Times.clear();
+	m_Decoded.Clear();
+	m_DecodedChunk = SIZE_MAX;
+}
+
+uint64_t TrajectoryReader::FindFrame(double time) const
+{
+	auto after = std::upper_bound(m_Times.begin(), m_Times.end(), time);
+
+	return after == m_Times.begin() ? 0 : (uint64_t)(after - m_Times.begin()) - 1;
+}
+
+bool TrajectoryReader::ReadFrame(uint64_t frame, TrajectoryRecorder::Frame& outFrame)
+{
+	if (frame >= GetFrameCount())
+	{
+		return false;
+	}
+
+	auto after = std::upper_bound(m_Chunks.begin(), m_Chunks.end(), frame,
+		[](uint64_t value, const ChunkEntry& chunk) { return value < chunk.FirstFrame; });
+	size_t chunkIdx = (size_t)(after - m_Chunks.begin()) - 1;
+	const ChunkEntry& chunk = m_Chunks[chunkIdx];
+
+	if (chunkIdx != m_DecodedChunk)
+	{
+		m_DecodedChunk = SIZE_MAX;
+
+		if (!TrajectoryCodec::Decode(m_File.GetData() + chunk.Offset, chunk.Size, m_Decoded))
+		{
+			LOG_ERROR("Trajectory chunk starting at frame {} is corrupted.", chunk.FirstFrame);
+
+			return false;
+		}
+
+		m_DecodedChunk = chunkIdx;
+	}
+
+	size_t bodyCount = m_Decoded.GetBodyCount();
+	size_t first = (frame - chunk.FirstFrame) * bodyCount;
+
+	outFrame.Time = m_Times[frame];
+	outFrame.BodyIds = m_Decoded.BodyIds;
+	outFrame.Positions.assign(m_Decoded.Positions.begin() + first, m_Decoded.Positions.begin() + first + bodyCount);
+	outFrame.Velocities.assign(m_Decoded.Velocities.begin() + first, m_Decoded.Velocities.begin() + first + bodyCount);
+
+	return true;
+}
\ No newline at end of file
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "TrajectoryCodec.hpp"
+#include "TrajectoryRecorder.hpp"
+#include "../JobSystem.hpp"
+#include "../random_utils/MappedFile.hpp"
+
+#include <glm/glm.hpp>
+
+#include <atomic>
+#include <deque>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+// Compressed recording on disk, a header followed by TrajectoryCodec chunks each prefixed with its size.
+// Every chunk starts with a full frame, so any frame can be decoded without touching earlier chunks.
+class TrajectoryWriter
+{
+public:
+	TrajectoryWriter() = default;
+	~TrajectoryWriter();
+
+	bool Open(const std::string& path, const TrajectoryCodec::Spec& spec);
+
+	// Writes what's still buffered and waits until every chunk is on disk
+	void Close();
+
+	// Copies the frame into the chunk being filled. Full chunks, and chunks the set of bodies changed in,
+	// get encoded on workers and written in order. Waits only when MAX_PENDING_CHUNKS of them are still in flight.
+	void Append(const std::vector<uint32_t>& bodyIds, const std::vector<glm::vec3>& positions, const std::vector<glm::vec3>& velocities, double time);
+
+	inline bool IsOpen() const { return m_File.is_open(); }
+	inline uint64_t GetFrameCount() const { return m_FrameCount; }
+
+	// Size the same frames would take as plain floats, and what they actually took so far
+	inline uint64_t GetRawBytes() const { return m_RawBytes; }
+	inline uint64_t GetWrittenBytes() const { return m_WrittenBytes; }
+
+	// Frames between two full ones, more compress better but make seeking decode more
+	uint32_t FramesPerChunk = 240;
+
+	inline static constexpr int32_t VERSION = 1;
+	inline static constexpr uint32_t MAX_PENDING_CHUNKS = 4;
+
+private:
+	void SubmitChunk();
+
+	std::ofstream m_File;
+	TrajectoryCodec::Spec m_Spec;
+	TrajectoryChunk m_Chunk;
+
+	// Write job of every chunk still in flight, each one depends on the one before so chunks land in order
+	std::deque<JobHandle> m_Pending;
+
+	uint64_t m_FrameCount = 0;
+	uint64_t m_RawBytes = 0;
+	std::atomic<uint64_t> m_WrittenBytes = 0;
+};
+
+// Random access to a compressed recording. The file is mapped and only chunk headers get read up front,
+// frames are decoded a whole chunk at a time when asked for.
+class TrajectoryReader
+{
+public:
+	bool Open(const std::string& path);
+	void Close();
+
+	inline uint64_t GetFrameCount() const { return m_Times.size(); }
+	inline double GetFrameTime(uint64_t frame) const { return m_Times[frame]; }
+
+	// Newest frame recorded at or before time, the first one when time precedes all of them
+	uint64_t FindFrame(double time) const;
+
+	// Playing frames in order decodes every chunk once, the last decoded one is kept around
+	bool ReadFrame(uint64_t frame, TrajectoryRecorder::Frame& outFrame);
+
+private:
+	struct ChunkEntry
+	{
+		size_t Offset = 0;
+		size_t Size = 0;
+		uint64_t FirstFrame = 0;
+	};
+
+	MappedFile m_File;
+	std::vector<ChunkEntry> m_Chunks;
+	std::vector<double> m_Times;
+
+	TrajectoryChunk m_Decoded;
+	size_t m_DecodedChunk = SIZE_MAX;
+};
\ No newline at end of file
@@ -0,0 +1,180 @@
+#include "TrajectoryRecorder.hpp"
+#include "../Logger.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
+TrajectoryRecorder::~TrajectoryRecorder()
+{
+	Close();
+}
+
+bool TrajectoryRecorder::Open(const std::string& path, uint32_t bodyCapacity, uint64_t frameCapacity)
+{
+	Close();
+
+	if (bodyCapacity == 0 || frameCapacity < 2)
+	{
+		return false;
+	}
+
+	size_t size = IndexOffset() + frameCapacity * sizeof(IndexEntry) + frameCapacity * FrameSize(bodyCapacity);
+
+	if (!m_File.Open(path, MappedFile::Access::ReadWrite, size))
+	{
+		return false;
+	}
+
+	m_BodyCapacity = bodyCapacity;
+	m_FrameCapacity = frameCapacity;
+	m_TicksSinceFrame = 0;
+
+	FileHeader& header = Header();
+	memcpy(header.Magic, "SSSTRAJ", 8);
+	header.Version = VERSION;
+	header.BodyCapacity = bodyCapacity;
+	header.FrameCapacity = frameCapacity;
+	header.FramesWritten = 0;
+
+	return true;
+}
+
+void TrajectoryRecorder::Close()
+{
+	m_File.Flush();
+	m_File.Close();
+	m_BodyCapacity = 0;
+	m_FrameCapacity = 0;
+}
+
+void TrajectoryRecorder::Record(const BodyStore& bodies, const std::vector<uint32_t>& bodyIds, double time)
+{
+	if (!IsOpen() || ++m_TicksSinceFrame < std::max(Decimation, 1u))
+	{
+		return;
+	}
+
+	m_TicksSinceFrame = 0;
+
+	uint64_t frame = Header().FramesWritten;
+	uint32_t count = (uint32_t)std::min<size_t>(bodies.Size(), m_BodyCapacity);
+	uint8_t* data = m_File.GetData() + FrameOffset(frame);
+
+	// Arrays sit at fixed offsets for the full capacity, so every frame of the file has the same layout
+	memcpy(data, bodyIds.data(), count * sizeof(uint32_t));
+	data += m_BodyCapacity * sizeof(uint32_t);
+	memcpy(data, bodies.Positions.data(), count * sizeof(glm::vec3));
+	data += m_BodyCapacity * sizeof(glm::vec3);
+	memcpy(data, bodies.Velocities.data(), count * sizeof(glm::vec3));
+
+	IndexEntry& entry = Index(frame);
+	entry.Time = time;
+	entry.BodyCount = count;
+
+	std::atomic_ref<uint64_t>(Header().FramesWritten).store(frame + 1, std::memory_order_release);
+}
+
+uint64_t TrajectoryRecorder::GetFrameCount() const
+{
+	if (!IsOpen())
+	{
+		return 0;
+	}
+
+	uint64_t written = std::atomic_ref<uint64_t>(Header().FramesWritten).load(std::memory_order_acquire);
+
+	return std::min(written, m_FrameCapacity - 1);
+}
+
+double TrajectoryRecorder::GetFrameTime(uint64_t frame) const
+{
+	return Index(FirstStoredFrame() + frame).Time;
+}
+
+uint64_t TrajectoryRecorder::FindFrame(double time) const
+{
+	uint64_t count = GetFrameCount();
+
+	if (count == 0)
+	{
+		return 0;
+	}
+
+	// Times only ever grow, the first frame recorded after time is found by bisection
+	uint64_t low = 0;
+	uint64_t high = count;
+
+	while (low < high)
+	{
+		uint64_t middle = low + (high - low) / 2;
+
+		if (GetFrameTime(middle) <= time)
+		{
+			low = middle + 1;
+		}
+		else
+		{
+			high = middle;
+		}
+	}
+
+	return low == 0 ? 0 : low - 1;
+}
+
+void TrajectoryRecorder::ReadFrame(uint64_t frame, Frame& outFrame) const
+{
+	uint64_t absoluteFrame = FirstStoredFrame() + frame;
+	const IndexEntry& entry = Index(absoluteFrame);
+	const uint8_t* data = m_File.GetData() + FrameOffset(absoluteFrame);
+
+	outFrame.Time = entry.Time;
+	outFrame.BodyIds.resize(entry.BodyCount);
+	outFrame.Positions.resize(entry.BodyCount);
+	outFrame.Velocities.resize(entry.BodyCount);
+
+	memcpy(outFrame.BodyIds.data(), data, entry.BodyCount * sizeof(uint32_t));
+	data += m_BodyCapacity * sizeof(uint32_t);
+	memcpy(outFrame.Positions.data(), data, entry.BodyCount * sizeof(glm::vec3));
+	data += m_BodyCapacity * sizeof(glm::vec3);
+	memcpy(outFrame.Velocities.data(), data, entry.BodyCount * sizeof(glm::vec3));
+}
+
+uint64_t TrajectoryRecorder::FramesForBudget(uint32_t bodyCount, uint64_t budgetBytes)
+{
+	return std::max<uint64_t>(budgetBytes / (FrameSize(std::max(bodyCount, 1u)) + sizeof(IndexEntry)), 2);
+}
+
+size_t TrajectoryRecorder::FrameSize(uint32_t bodyCapacity)
+{
+	return bodyCapacity * (sizeof(uint32_t) + 2 * sizeof(glm::vec3));
+}
+
+size_t TrajectoryRecorder::IndexOffset()
+{
+	// Keeps the index entries aligned no matter what the header grows into
+	return (sizeof(FileHeader) + 63) / 64 * 64;
+}
+
+size_t TrajectoryRecorder::FrameOffset(uint64_t absoluteFrame) const
+{
+	return IndexOffset() + m_FrameCapacity * sizeof(IndexEntry) + (absoluteFrame % m_FrameCapacity) * FrameSize(m_BodyCapacity);
+}
+
+TrajectoryRecorder::FileHeader& TrajectoryRecorder::Header() const
+{
+	return *(FileHeader*)m_File.GetData();
+}
+
+TrajectoryRecorder::IndexEntry& TrajectoryRecorder::Index(uint64_t absoluteFrame) const
+{
+	return ((IndexEntry*)(m_File.GetData() + IndexOffset()))[absoluteFrame % m_FrameCapacity];
+}
+
+uint64_t TrajectoryRecorder::FirstStoredFrame() const
+{
+	uint64_t written = std::atomic_ref<uint64_t>(Header().FramesWritten).load(std::memory_order_acquire);
+
+	// Slot the next frame goes into never counts as stored, so a reader can't catch it half overwritten
+	return written >= m_FrameCapacity ? written - m_FrameCapacity + 1 : 0;
+}
\ No newline at end of file
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "BodyStore.hpp"
+#include "../random_utils/MappedFile.hpp"
+
+#include <glm/glm.hpp>
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+// Past states of every body, kept in a memory-mapped file used as a ring buffer of fixed-size frames.
+// Recording copies the state straight into the mapping, no intermediate buffer and no system calls, writing back is left to the OS.
+// A separate index of frame times sits in front of the frames, so seeking only ever touches the index pages.
+class TrajectoryRecorder
+{
+public:
+	struct Frame
+	{
+		double Time = 0.0;
+		std::vector<uint32_t> BodyIds;
+		std::vector<glm::vec3> Positions;
+		std::vector<glm::vec3> Velocities;
+	};
+
+	TrajectoryRecorder() = default;
+	~TrajectoryRecorder();
+
+	// Creates the file with room for frameCapacity frames of up to bodyCapacity bodies, existing contents are discarded.
+	// One of the frames is always the next to be overwritten, so frameCapacity - 1 of them stay readable.
+	bool Open(const std::string& path, uint32_t bodyCapacity, uint64_t frameCapacity);
+	void Close();
+
+	// Meant to be called every tick, only every Decimation-th call stores a frame.
+	// Bodies past the capacity given to Open are left out.
+	void Record(const BodyStore& bodies, const std::vector<uint32_t>& bodyIds, double time);
+
+	// Frames still stored, 0 is the oldest one
+	uint64_t GetFrameCount() const;
+	double GetFrameTime(uint64_t frame) const;
+
+	// Newest stored frame recorded at or before time, the oldest one when time precedes all of them
+	uint64_t FindFrame(double time) const;
+	void ReadFrame(uint64_t frame, Frame& outFrame) const;
+
+	inline bool IsOpen() const { return m_File.IsOpen(); }
+	inline uint64_t GetFrameCapacity() const { return m_FrameCapacity; }
+
+	// Frame capacity that fits bodyCount bodies into the given number of bytes
+	static uint64_t FramesForBudget(uint32_t bodyCount, uint64_t budgetBytes);
+
+	uint32_t Decimation = 1;
+
+	inline static constexpr int32_t VERSION = 1;
+
+private:
+	struct FileHeader
+	{
+		char Magic[8];
+		int32_t Version;
+		uint32_t BodyCapacity;
+		uint64_t FrameCapacity;
+
+		// Published after a frame is complete, anything below it can be read
+		uint64_t FramesWritten;
+	};
+
+	struct IndexEntry
+	{
+		double Time;
+		uint32_t BodyCount;
+		uint32_t Padding;
+	};
+
+	static size_t FrameSize(uint32_t bodyCapacity);
+	static size_t IndexOffset();
+	size_t FrameOffset(uint64_t absoluteFrame) const;
+
+	FileHeader& Header() const;
+	IndexEntry& Index(uint64_t absoluteFrame) const;
+	uint64_t FirstStoredFrame() const;
+
+	MappedFile m_File;
+	uint32_t m_BodyCapacity = 0;
+	uint64_t m_FrameCapacity = 0;
+	uint64_t m_TicksSinceFrame = 0;
+};
\ No newline at end of file
@@ -0,0 +1,110 @@
+#include "FileUtils.hpp"
+#include "../Logger.hpp"
+
+#include <filesystem>
+#include <algorithm>
+
+#ifdef _WIN32
+	#define WIN32_LEAN_AND_MEAN
+	#define NOMINMAX
+	#include <windows.h>
+#else
+	#include <fcntl.h>
+	#include <unistd.h>
+#endif
+
+namespace FileUtils
+{
+#ifdef _WIN32
+
+	bool WriteAtomically(const std::string& path, const void* data, size_t size)
+	{
+		std::string tempPath = path + ".tmp";
+		HANDLE file = CreateFileA(tempPath.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+		if (file == INVALID_HANDLE_VALUE)
+		{
+			LOG_ERROR("File {} could not be created/opened.", tempPath);
+
+			return false;
+		}
+
+		const uint8_t* bytes = (const uint8_t*)data;
+		bool written = true;
+
+		while (written && size > 0)
+		{
+			DWORD chunk = (DWORD)std::min<size_t>(size, 1u << 30);
+			DWORD done = 0;
+			written = WriteFile(file, bytes, chunk, &done, nullptr) && done == chunk;
+
+			bytes += done;
+			size -= done;
+		}
+
+		written = written && FlushFileBuffers(file);
+		CloseHandle(file);
+
+		if (!written || !MoveFileExA(tempPath.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH))
+		{
+			LOG_ERROR("{} could not be written.", path);
+			DeleteFileA(tempPath.c_str());
+
+			return false;
+		}
+
+		return true;
+	}
+
+#else
+
+	bool WriteAtomically(const std::string& path, const void* data, size_t size)
+	{
+		std::string tempPath = path + ".tmp";
+		int32_t file = open(tempPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+		if (file < 0)
+		{
+			LOG_ERROR("File {} could not be created/opened.", tempPath);
+
+			return false;
+		}
+
+		const uint8_t* bytes = (const uint8_t*)data;
+		bool written = true;
+
+		while (written && size > 0)
+		{
+			ssize_t done = write(file, bytes, size);
+			written = done > 0;
+
+			bytes += written ? done : 0;
+			size -= written ? done : 0;
+		}
+
+		written = written && fsync(file) == 0;
+		close(file);
+
+		if (!written || rename(tempPath.c_str(), path.c_str()) != 0)
+		{
+			LOG_ERROR("{} could not be written.", path);
+			unlink(tempPath.c_str());
+
+			return false;
+		}
+
+		// Rename itself only survives a crash once the directory entry is on the disk too
+		std::string directory = std::filesystem::absolute(path).parent_path().string();
+		int32_t directoryFile = open(directory.c_str(), O_RDONLY);
+
+		if (directoryFile >= 0)
+		{
+			fsync(directoryFile);
+			close(directoryFile);
+		}
+
+		return true;
+	}
+
+#endif
+}
\ No newline at end of file
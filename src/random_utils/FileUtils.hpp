@@ -0,0 +1,10 @@
+#pragma once
+
+#include <string>
+
+namespace FileUtils
+{
+	// Writes next to path first, flushes it to the disk and renames it over path.
+	// Readers, and whatever is left after a crash, see either the old file or the whole new one.
+	bool WriteAtomically(const std::string& path, const void* data, size_t size);
+}
\ No newline at end of file
@@ -0,0 +1,191 @@
+#include "MappedFile.hpp"
+#include "../Logger.hpp"
+
+#ifdef _WIN32
+	#define WIN32_LEAN_AND_MEAN
+	#define NOMINMAX
+	#include <windows.h>
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile()
+{
+	Close();
+}
+
+#ifdef _WIN32
+
+bool MappedFile::Open(const std::string& path, Access access, size_t size)
+{
+	Close();
+
+	bool writable = access == Access::ReadWrite;
+	HANDLE file = CreateFileA(path.c_str(), writable ? GENERIC_READ | GENERIC_WRITE : GENERIC_READ, FILE_SHARE_READ, nullptr,
+		writable ? OPEN_ALWAYS : OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		LOG_ERROR("{} could not be opened for mapping.", path);
+
+		return false;
+	}
+
+	LARGE_INTEGER fileSize{};
+
+	if (writable && size != 0)
+	{
+		fileSize.QuadPart = (LONGLONG)size;
+
+		if (!SetFilePointerEx(file, fileSize, nullptr, FILE_BEGIN) || !SetEndOfFile(file))
+		{
+			LOG_ERROR("{} could not be resized to {} bytes.", path, size);
+			CloseHandle(file);
+
+			return false;
+		}
+	}
+	else
+	{
+		GetFileSizeEx(file, &fileSize);
+	}
+
+	if (fileSize.QuadPart == 0)
+	{
+		LOG_ERROR("{} is empty, nothing to map.", path);
+		CloseHandle(file);
+
+		return false;
+	}
+
+	HANDLE mapping = CreateFileMappingA(file, nullptr, writable ? PAGE_READWRITE : PAGE_READONLY, 0, 0, nullptr);
+	void* data = mapping ? MapViewOfFile(mapping, writable ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, 0) : nullptr;
+
+	if (data == nullptr)
+	{
+		LOG_ERROR("{} could not be mapped.", path);
+
+		if (mapping)
+		{
+			CloseHandle(mapping);
+		}
+
+		CloseHandle(file);
+
+		return false;
+	}
+
+	m_File = file;
+	m_Mapping = mapping;
+	m_Data = (uint8_t*)data;
+	m_Size = (size_t)fileSize.QuadPart;
+
+	return true;
+}
+
+void MappedFile::Close()
+{
+	if (m_Data)
+	{
+		UnmapViewOfFile(m_Data);
+		CloseHandle(m_Mapping);
+		CloseHandle(m_File);
+	}
+
+	m_Data = nullptr;
+	m_Size = 0;
+	m_File = nullptr;
+	m_Mapping = nullptr;
+}
+
+void MappedFile::Flush()
+{
+	if (m_Data)
+	{
+		FlushViewOfFile(m_Data, 0);
+	}
+}
+
+#else
+
+bool MappedFile::Open(const std::string& path, Access access, size_t size)
+{
+	Close();
+
+	bool writable = access == Access::ReadWrite;
+	int32_t file = open(path.c_str(), writable ? O_RDWR | O_CREAT : O_RDONLY, 0644);
+
+	if (file < 0)
+	{
+		LOG_ERROR("{} could not be opened for mapping.", path);
+
+		return false;
+	}
+
+	if (writable && size != 0)
+	{
+		if (ftruncate(file, (off_t)size) != 0)
+		{
+			LOG_ERROR("{} could not be resized to {} bytes.", path, size);
+			close(file);
+
+			return false;
+		}
+	}
+	else
+	{
+		struct stat info{};
+		fstat(file, &info);
+		size = (size_t)info.st_size;
+	}
+
+	if (size == 0)
+	{
+		LOG_ERROR("{} is empty, nothing to map.", path);
+		close(file);
+
+		return false;
+	}
+
+	void* data = mmap(nullptr, size, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, file, 0);
+
+	if (data == MAP_FAILED)
+	{
+		LOG_ERROR("{} could not be mapped.", path);
+		close(file);
+
+		return false;
+	}
+
+	m_File = file;
+	m_Data = (uint8_t*)data;
+	m_Size = size;
+
+	return true;
+}
+
+void MappedFile::Close()
+{
+	if (m_Data)
+	{
+		munmap(m_Data, m_Size);
+		close(m_File);
+	}
+
+	m_Data = nullptr;
+	m_Size = 0;
+	m_File = -1;
+}
+
+void MappedFile::Flush()
+{
+	if (m_Data)
+	{
+		msync(m_Data, m_Size, MS_ASYNC);
+	}
+}
+
+#endif
\ No newline at end of file
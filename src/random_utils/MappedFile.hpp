@@ -0,0 +1,46 @@
+#pragma once
+
+#include <string>
+#include <cstdint>
+
+// File mapped straight into the address space. Reads and writes go through plain memory,
+// the OS pages data in and writes it back on its own, no read or write calls anywhere.
+class MappedFile
+{
+public:
+	enum class Access
+	{
+		Read,
+		ReadWrite
+	};
+
+	MappedFile() = default;
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	// ReadWrite with a non-zero size creates the file or resizes an existing one to exactly that many bytes,
+	// otherwise the whole existing file gets mapped
+	bool Open(const std::string& path, Access access, size_t size = 0);
+	void Close();
+
+	// Starts writing dirty pages back without waiting for the disk
+	void Flush();
+
+	inline bool IsOpen() const { return m_Data != nullptr; }
+	inline uint8_t* GetData() { return m_Data; }
+	inline const uint8_t* GetData() const { return m_Data; }
+	inline size_t GetSize() const { return m_Size; }
+
+private:
+	uint8_t* m_Data = nullptr;
+	size_t m_Size = 0;
+
+#ifdef _WIN32
+	void* m_File = nullptr;
+	void* m_Mapping = nullptr;
+#else
+	int32_t m_File = -1;
+#endif
+};
\ No newline at end of file
@@ -0,0 +1,72 @@
+#include "SceneAutosaver.hpp"
+#include "SceneSerializer.hpp"
+#include "../Logger.hpp"
+#include "../scenes/EditorScene.hpp"
+
+#include <filesystem>
+
+SceneAutosaver::~SceneAutosaver()
+{
+	Wait();
+}
+
+void SceneAutosaver::OnUpdate(const EditorScene& scene, float ts)
+{
+	m_SinceSave += ts;
+
+	if (!Enabled || m_SinceSave < IntervalSeconds || !JobSystem::IsDone(m_Job))
+	{
+		return;
+	}
+
+	m_SinceSave = 0.0f;
+
+	SceneFile sceneFile = SceneSerializer::CaptureScene(scene);
+	uint64_t hash = sceneFile.Hash();
+
+	if (hash == m_AutosavedHash)
+	{
+		return;
+	}
+
+	Submit(std::move(sceneFile), GetAutosavePath(scene.GetName()), hash);
+}
+
+void SceneAutosaver::Save(const EditorScene& scene, const std::string& path)
+{
+	Submit(SceneSerializer::CaptureScene(scene), path, {});
+}
+
+void SceneAutosaver::Submit(SceneFile sceneFile, const std::string& path, std::optional<uint64_t> autosaveHash)
+{
+	Wait();
+
+	m_SinceSave = 0.0f;
+	m_Job = JobSystem::Submit([this, sceneFile = std::move(sceneFile), path, autosaveHash]()
+		{
+			if (!sceneFile.Write(path))
+			{
+				LOG_ERROR("Saving scene {} failed: file {} could not be written.", sceneFile.Name, std::filesystem::absolute(path).string());
+
+				return;
+			}
+
+			if (autosaveHash.has_value())
+			{
+				m_AutosavedHash = *autosaveHash;
+			}
+
+			LOG_INFO("Saved scene {} to: {}", sceneFile.Name, std::filesystem::absolute(path).string());
+		});
+}
+
+void SceneAutosaver::Wait()
+{
+	JobSystem::Wait(m_Job);
+}
+
+std::string SceneAutosaver::GetAutosavePath(const std::string& sceneName)
+{
+	// Kept apart from the scene's own file, an autosave never overwrites what the user saved on purpose
+	return SceneSerializer::GetSavePath(sceneName + ".autosave");
+}
\ No newline at end of file
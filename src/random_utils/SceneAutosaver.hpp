@@ -0,0 +1,43 @@
+#pragma once
+
+#include "../JobSystem.hpp"
+#include "SceneFile.hpp"
+
+#include <atomic>
+#include <optional>
+#include <string>
+
+class EditorScene;
+
+// Saves the editor's scene on a worker. The scene gets captured into a plain SceneFile on the calling thread,
+// which with at most SceneObject::MAX_OBJECTS objects costs next to nothing. Serializing, flushing it to the disk
+// and renaming it over the previous file all happen in the background, so saving never stalls a frame.
+class SceneAutosaver
+{
+public:
+	SceneAutosaver() = default;
+	~SceneAutosaver();
+
+	// Call every frame, saves next to the scene's own file once the interval passed and the previous save is done.
+	// A scene unchanged since the last autosave is skipped, leaving the editor open doesn't rewrite the same file.
+	void OnUpdate(const EditorScene& scene, float ts);
+
+	// Waits for a save still in flight first, two writes of the same file must not overlap
+	void Save(const EditorScene& scene, const std::string& path);
+	void Wait();
+
+	static std::string GetAutosavePath(const std::string& sceneName);
+
+	bool Enabled = true;
+	float IntervalSeconds = 60.0f;
+
+private:
+	// With autosaveHash given, it becomes the last autosaved scene once the write succeeds
+	void Submit(SceneFile sceneFile, const std::string& path, std::optional<uint64_t> autosaveHash);
+
+	JobHandle m_Job;
+	float m_SinceSave = 0.0f;
+
+	// Written by the save job, a failed write keeps the old one so the next interval tries again
+	std::atomic<uint64_t> m_AutosavedHash = 0;
+};
\ No newline at end of file
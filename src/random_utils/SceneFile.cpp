@@ -0,0 +1,706 @@
+#include "SceneFile.hpp"
+#include "MappedFile.hpp"
+#include "FileUtils.hpp"
+#include "../Logger.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <unordered_map>
+#include <type_traits>
+#include <string_view>
+#include <cstring>
+
+namespace
+{
+	// Strings are stored with their terminating null, which the length counts in
+	std::string ReadString(std::fstream& file, uint64_t fileSize)
+	{
+		int32_t length{};
+		file.read((char*)&length, sizeof(int32_t));
+
+		if (!file.good() || length <= 0)
+		{
+			return {};
+		}
+
+		// A corrupt length must not turn into a huge allocation, fail the stream so the caller reports it
+		if ((uint64_t)length > fileSize - (uint64_t)file.tellg())
+		{
+			file.setstate(std::ios::failbit);
+
+			return {};
+		}
+
+		std::string str(length, '\0');
+		file.read(str.data(), length);
+		str.resize(std::strlen(str.c_str()));
+
+		return str;
+	}
+
+	bool IsValidType(uint32_t type)
+	{
+		return type <= (uint32_t)ObjectType::Sun;
+	}
+
+	constexpr char LEGACY_MAGIC[9] = "SSSSCENE";
+	constexpr char CHUNKED_MAGIC[8] = "SSSBULK";
+
+	// Chunk starts are aligned so arrays in a mapped file sit at addresses fit for their element type
+	constexpr size_t CHUNK_ALIGNMENT = 16;
+
+	// Stored in files, existing values must never change
+	enum class ChunkId : uint32_t
+	{
+		Info			  = 1,
+		Types			  = 2,
+		Tags			  = 3,
+		Positions		  = 4,
+		Rotations		  = 5,
+		Scales			  = 6,
+		LinearVelocities  = 7,
+		AngularVelocities = 8,
+		Masses			  = 9,
+		Colors			  = 10,
+		Shininess		  = 11,
+		Roughness		  = 12,
+		TexturePaths	  = 13,
+		TextureIds		  = 14,
+		Lights			  = 15,
+
+		Count
+	};
+
+	struct FileHeader
+	{
+		char Magic[8]{};
+		uint32_t Version = 0;
+		uint32_t ChunkCount = 0;
+		uint64_t ObjectCount = 0;
+	};
+
+	struct ChunkEntry
+	{
+		ChunkId Id{};
+		uint32_t Reserved = 0;
+		uint64_t Offset = 0;
+		uint64_t Size = 0;
+	};
+
+	struct ChunkView
+	{
+		const uint8_t* Data = nullptr;
+		size_t Size = 0;
+	};
+
+	// Builds the whole file in memory, so it goes to disk with a single write
+	class ChunkWriter
+	{
+	public:
+		ChunkWriter()
+			: m_Data(sizeof(FileHeader) + (size_t)ChunkId::Count * sizeof(ChunkEntry))
+		{}
+
+		void Begin(ChunkId id)
+		{
+			m_Data.resize((m_Data.size() + CHUNK_ALIGNMENT - 1) / CHUNK_ALIGNMENT * CHUNK_ALIGNMENT);
+			m_Entries.push_back({ id, 0, m_Data.size(), 0 });
+		}
+
+		void End()
+		{
+			m_Entries.back().Size = m_Data.size() - m_Entries.back().Offset;
+		}
+
+		void Append(const void* data, size_t size)
+		{
+			m_Data.insert(m_Data.end(), (const uint8_t*)data, (const uint8_t*)data + size);
+		}
+
+		// One field out of every object, laid out as a plain array
+		template<typename T, typename Getter>
+		void AppendField(const std::vector<SceneFile::ObjectRecord>& objects, Getter getter)
+		{
+			static_assert(std::is_trivially_copyable_v<T>, "Only plain values can be stored as arrays");
+
+			size_t offset = m_Data.size();
+			m_Data.resize(offset + objects.size() * sizeof(T));
+
+			for (size_t i = 0; i < objects.size(); i++)
+			{
+				const T& value = getter(objects[i]);
+				std::memcpy(m_Data.data() + offset + i * sizeof(T), &value, sizeof(T));
+			}
+		}
+
+		// Count, then count + 1 offsets into the characters that follow, no terminating nulls
+		void AppendStrings(const std::vector<const std::string*>& strings)
+		{
+			uint32_t count = (uint32_t)strings.size();
+			uint32_t offset = 0;
+			Append(&count, sizeof(uint32_t));
+			Append(&offset, sizeof(uint32_t));
+
+			for (const std::string* str : strings)
+			{
+				offset += (uint32_t)str->size();
+				Append(&offset, sizeof(uint32_t));
+			}
+
+			for (const std::string* str : strings)
+			{
+				Append(str->data(), str->size());
+			}
+		}
+
+		std::vector<uint8_t>& Finish(uint64_t objectCount)
+		{
+			FileHeader header;
+			std::memcpy(header.Magic, CHUNKED_MAGIC, sizeof(header.Magic));
+			header.Version = SceneFile::VERSION;
+			header.ChunkCount = (uint32_t)m_Entries.size();
+			header.ObjectCount = objectCount;
+
+			std::memcpy(m_Data.data(), &header, sizeof(FileHeader));
+			std::memcpy(m_Data.data() + sizeof(FileHeader), m_Entries.data(), m_Entries.size() * sizeof(ChunkEntry));
+
+			return m_Data;
+		}
+
+	private:
+		std::vector<uint8_t> m_Data;
+		std::vector<ChunkEntry> m_Entries;
+	};
+
+	// Missing chunks leave the defaults in place, a chunk of the wrong size means a broken file
+	template<typename T>
+	bool IsArrayOf(const ChunkView& chunk, size_t count)
+	{
+		return chunk.Data == nullptr || chunk.Size == count * sizeof(T);
+	}
+
+	template<typename T, typename Setter>
+	void ReadField(const ChunkView& chunk, std::vector<SceneFile::ObjectRecord>& objects, Setter setter)
+	{
+		if (chunk.Data == nullptr)
+		{
+			return;
+		}
+
+		for (size_t i = 0; i < objects.size(); i++)
+		{
+			T value;
+			std::memcpy(&value, chunk.Data + i * sizeof(T), sizeof(T));
+			setter(objects[i], value);
+		}
+	}
+
+	template<typename T>
+	void CopyArray(const ChunkView& chunk, size_t count, const T& fallback, std::vector<T>& outValues)
+	{
+		if (chunk.Data == nullptr)
+		{
+			outValues.assign(count, fallback);
+
+			return;
+		}
+
+		outValues.resize(count);
+		std::memcpy(outValues.data(), chunk.Data, count * sizeof(T));
+	}
+
+	// Hands every string to setter along with its index, without collecting them anywhere first
+	template<typename Setter>
+	bool ReadStrings(const ChunkView& chunk, size_t& outCount, Setter setter)
+	{
+		uint32_t count = 0;
+
+		if (chunk.Size < sizeof(uint32_t))
+		{
+			return false;
+		}
+
+		std::memcpy(&count, chunk.Data, sizeof(uint32_t));
+
+		size_t charsOffset = sizeof(uint32_t) * ((size_t)count + 2);
+
+		if (count > chunk.Size / sizeof(uint32_t) || charsOffset > chunk.Size)
+		{
+			return false;
+		}
+
+		const uint8_t* offsets = chunk.Data + sizeof(uint32_t);
+		size_t charsSize = chunk.Size - charsOffset;
+		uint32_t begin = 0;
+		std::memcpy(&begin, offsets, sizeof(uint32_t));
+
+		outCount = count;
+
+		for (uint32_t i = 0; i < count; i++)
+		{
+			uint32_t end = 0;
+			std::memcpy(&end, offsets + (i + 1) * sizeof(uint32_t), sizeof(uint32_t));
+
+			if (end < begin || end > charsSize)
+			{
+				return false;
+			}
+
+			setter(i, std::string_view((const char*)chunk.Data + charsOffset + begin, end - begin));
+			begin = end;
+		}
+
+		return true;
+	}
+}
+
+std::optional<SceneFile> SceneFile::Read(const std::string& path, BodyStore* outBodies)
+{
+	std::filesystem::path readPath = std::filesystem::path(path);
+	if (!std::filesystem::exists(readPath))
+	{
+		LOG_ERROR("Path {} does not exist.", readPath.string());
+
+		return {};
+	}
+
+	MappedFile file;
+	if (!file.Open(path, MappedFile::Access::Read))
+	{
+		return {};
+	}
+
+	if (file.GetSize() >= sizeof(LEGACY_MAGIC) && std::memcmp(file.GetData(), LEGACY_MAGIC, sizeof(LEGACY_MAGIC)) == 0)
+	{
+		file.Close();
+
+		std::optional<SceneFile> scene = ReadLegacy(path);
+
+		if (scene.has_value() && outBodies != nullptr)
+		{
+			outBodies->Resize(scene->Objects.size());
+
+			for (size_t i = 0; i < scene->Objects.size(); i++)
+			{
+				outBodies->Positions[i]  = scene->Objects[i].ObjectTransform.Position;
+				outBodies->Velocities[i] = scene->Objects[i].ObjectPhysics.LinearVelocity;
+				outBodies->Masses[i]	 = scene->Objects[i].ObjectPhysics.Mass;
+			}
+		}
+
+		return scene;
+	}
+
+	std::optional<SceneFile> scene = ReadChunked(file.GetData(), file.GetSize(), outBodies);
+
+	if (!scene.has_value())
+	{
+		LOG_ERROR("{} is not a valid scene file.", std::filesystem::absolute(readPath).string());
+	}
+
+	return scene;
+}
+
+std::optional<SceneFile> SceneFile::ReadChunked(const uint8_t* data, size_t size, BodyStore* outBodies)
+{
+	FileHeader header;
+
+	if (size < sizeof(FileHeader))
+	{
+		return {};
+	}
+
+	std::memcpy(&header, data, sizeof(FileHeader));
+
+	if (std::memcmp(header.Magic, CHUNKED_MAGIC, sizeof(header.Magic)) != 0)
+	{
+		LOG_ERROR("Wrong scene file header.");
+
+		return {};
+	}
+
+	if (header.Version > VERSION)
+	{
+		LOG_ERROR("Scene file version {} is newer than the supported {}.", header.Version, VERSION);
+
+		return {};
+	}
+
+	if (header.ChunkCount > (size - sizeof(FileHeader)) / sizeof(ChunkEntry))
+	{
+		return {};
+	}
+
+	ChunkView chunks[(size_t)ChunkId::Count]{};
+
+	for (uint32_t i = 0; i < header.ChunkCount; i++)
+	{
+		ChunkEntry entry;
+		std::memcpy(&entry, data + sizeof(FileHeader) + i * sizeof(ChunkEntry), sizeof(ChunkEntry));
+
+		if (entry.Offset > size || entry.Size > size - entry.Offset)
+		{
+			return {};
+		}
+
+		if ((size_t)entry.Id < (size_t)ChunkId::Count)
+		{
+			chunks[(size_t)entry.Id] = { data + entry.Offset, (size_t)entry.Size };
+		}
+	}
+
+	auto chunk = [&chunks](ChunkId id) -> const ChunkView& { return chunks[(size_t)id]; };
+	size_t count = (size_t)header.ObjectCount;
+
+	// Types are the one required array, which also keeps a broken object count from allocating anything huge
+	const ChunkView& info = chunk(ChunkId::Info);
+	const ChunkView& types = chunk(ChunkId::Types);
+
+	if (info.Size < sizeof(CameraRecord) || types.Data == nullptr || types.Size != count)
+	{
+		return {};
+	}
+
+	bool sized = IsArrayOf<glm::vec3>(chunk(ChunkId::Positions), count) && IsArrayOf<glm::vec3>(chunk(ChunkId::Rotations), count)
+		&& IsArrayOf<glm::vec3>(chunk(ChunkId::Scales), count) && IsArrayOf<glm::vec3>(chunk(ChunkId::LinearVelocities), count)
+		&& IsArrayOf<glm::vec3>(chunk(ChunkId::AngularVelocities), count) && IsArrayOf<float>(chunk(ChunkId::Masses), count)
+		&& IsArrayOf<glm::vec4>(chunk(ChunkId::Colors), count) && IsArrayOf<float>(chunk(ChunkId::Shininess), count)
+		&& IsArrayOf<float>(chunk(ChunkId::Roughness), count) && IsArrayOf<uint32_t>(chunk(ChunkId::TextureIds), count * 3)
+		&& IsArrayOf<PointLight>(chunk(ChunkId::Lights), count);
+
+	if (!sized)
+	{
+		return {};
+	}
+
+	SceneFile scene;
+
+	// Scene info and camera
+	std::memcpy(&scene.Camera, info.Data, sizeof(CameraRecord));
+	scene.Name.assign((const char*)info.Data + sizeof(CameraRecord), info.Size - sizeof(CameraRecord));
+
+	scene.Objects.resize(count);
+
+	for (size_t i = 0; i < count; i++)
+	{
+		if (!IsValidType(types.Data[i]))
+		{
+			return {};
+		}
+
+		scene.Objects[i].Type = (ObjectType)types.Data[i];
+	}
+
+	// Objects, one field at a time
+	ReadField<glm::vec3>(chunk(ChunkId::Positions), scene.Objects, [](ObjectRecord& object, const glm::vec3& value) { object.ObjectTransform.Position = value; });
+	ReadField<glm::vec3>(chunk(ChunkId::Rotations), scene.Objects, [](ObjectRecord& object, const glm::vec3& value) { object.ObjectTransform.Rotation = value; });
+	ReadField<glm::vec3>(chunk(ChunkId::Scales), scene.Objects, [](ObjectRecord& object, const glm::vec3& value) { object.ObjectTransform.Scale = value; });
+	ReadField<glm::vec3>(chunk(ChunkId::LinearVelocities), scene.Objects, [](ObjectRecord& object, const glm::vec3& value) { object.ObjectPhysics.LinearVelocity = value; });
+	ReadField<glm::vec3>(chunk(ChunkId::AngularVelocities), scene.Objects, [](ObjectRecord& object, const glm::vec3& value) { object.ObjectPhysics.AngularVelocity = value; });
+	ReadField<float>(chunk(ChunkId::Masses), scene.Objects, [](ObjectRecord& object, float value) { object.ObjectPhysics.Mass = value; });
+	ReadField<glm::vec4>(chunk(ChunkId::Colors), scene.Objects, [](ObjectRecord& object, const glm::vec4& value) { object.Color = value; });
+	ReadField<float>(chunk(ChunkId::Shininess), scene.Objects, [](ObjectRecord& object, float value) { object.Shininess = value; });
+	ReadField<float>(chunk(ChunkId::Roughness), scene.Objects, [](ObjectRecord& object, float value) { object.Roughness = value; });
+	ReadField<PointLight>(chunk(ChunkId::Lights), scene.Objects, [](ObjectRecord& object, const PointLight& value) { object.Light = value; });
+
+	// Strings
+	size_t tagCount = 0;
+	auto setTag = [&scene](uint32_t idx, std::string_view tag)
+		{
+			if (idx < scene.Objects.size())
+			{
+				scene.Objects[idx].Tag = tag;
+			}
+		};
+
+	if (chunk(ChunkId::Tags).Data != nullptr && (!ReadStrings(chunk(ChunkId::Tags), tagCount, setTag) || tagCount != count))
+	{
+		return {};
+	}
+
+	// Every path is stored once, objects refer to them by index
+	std::vector<std::string> paths;
+	const ChunkView& textureIds = chunk(ChunkId::TextureIds);
+
+	if (textureIds.Data != nullptr)
+	{
+		size_t pathCount = 0;
+		auto addPath = [&paths](uint32_t, std::string_view path) { paths.emplace_back(path); };
+
+		if (!ReadStrings(chunk(ChunkId::TexturePaths), pathCount, addPath))
+		{
+			return {};
+		}
+
+		for (size_t i = 0; i < count; i++)
+		{
+			uint32_t ids[3]{};
+			std::memcpy(ids, textureIds.Data + i * sizeof(ids), sizeof(ids));
+
+			if (ids[0] >= paths.size() || ids[1] >= paths.size() || ids[2] >= paths.size())
+			{
+				return {};
+			}
+
+			scene.Objects[i].AlbedoPath	  = paths[ids[0]];
+			scene.Objects[i].NormalPath	  = paths[ids[1]];
+			scene.Objects[i].SpecularPath = paths[ids[2]];
+		}
+	}
+
+	// Straight out of the mapped arrays, the objects aren't looked at
+	if (outBodies != nullptr)
+	{
+		CopyArray(chunk(ChunkId::Positions), count, Transform{}.Position, outBodies->Positions);
+		CopyArray(chunk(ChunkId::LinearVelocities), count, Physics{}.LinearVelocity, outBodies->Velocities);
+		CopyArray(chunk(ChunkId::Masses), count, Physics{}.Mass, outBodies->Masses);
+	}
+
+	return scene;
+}
+
+std::optional<SceneFile> SceneFile::ReadLegacy(const std::string& path)
+{
+	std::filesystem::path readPath = std::filesystem::path(path);
+	std::fstream file(readPath, std::ios::in | std::ios::binary);
+	if (!file.good())
+	{
+		LOG_ERROR("File {} could not be opened.", std::filesystem::absolute(readPath).string());
+
+		file.close();
+		return {};
+	}
+
+	char header[9]{};
+	file.read(header, 9);
+
+	if (strncmp(header, "SSSSCENE", 9) != 0)
+	{
+		LOG_ERROR("Wrong scene file header.");
+
+		file.close();
+		return {};
+	}
+
+	const uint64_t fileSize = std::filesystem::file_size(readPath);
+
+	SceneFile scene;
+
+	// Scene info
+	scene.Name = ReadString(file, fileSize);
+
+	// Camera
+	file.read((char*)&scene.Camera.AspectRatio, sizeof(float));
+	file.read((char*)&scene.Camera.NearClip,	sizeof(float));
+	file.read((char*)&scene.Camera.FarClip,		sizeof(float));
+	file.read((char*)&scene.Camera.FOV,			sizeof(float));
+	file.read((char*)&scene.Camera.Pitch,		sizeof(float));
+	file.read((char*)&scene.Camera.Yaw,			sizeof(float));
+	file.read((char*)&scene.Camera.Position,	sizeof(glm::vec3));
+
+	// Objects
+	int32_t objectsCount{};
+	file.read((char*)&objectsCount, sizeof(int32_t));
+
+	for (int32_t i = 0; i < objectsCount && file.good(); i++)
+	{
+		ObjectRecord& object = scene.Objects.emplace_back();
+
+		// Object info
+		object.Tag = ReadString(file, fileSize);
+		file.read((char*)&object.Type, sizeof(ObjectType));
+
+		if (file.good() && !IsValidType((uint32_t)object.Type))
+		{
+			LOG_ERROR("Scene file {} has an object of unknown type {}.", std::filesystem::absolute(readPath).string(), (uint32_t)object.Type);
+
+			return {};
+		}
+
+		// Transform
+		file.read((char*)&object.ObjectTransform.Position, sizeof(glm::vec3));
+		file.read((char*)&object.ObjectTransform.Rotation, sizeof(glm::vec3));
+		file.read((char*)&object.ObjectTransform.Scale,	   sizeof(glm::vec3));
+
+		// Physics
+		file.read((char*)&object.ObjectPhysics.LinearVelocity,	sizeof(glm::vec3));
+		file.read((char*)&object.ObjectPhysics.AngularVelocity, sizeof(glm::vec3));
+		file.read((char*)&object.ObjectPhysics.Mass,			sizeof(float));
+
+		// Material
+		file.read((char*)&object.Color,		sizeof(glm::vec4));
+		file.read((char*)&object.Shininess, sizeof(float));
+		file.read((char*)&object.Roughness, sizeof(float));
+
+		// Textures
+		object.AlbedoPath	= ReadString(file, fileSize);
+		object.NormalPath	= ReadString(file, fileSize);
+		object.SpecularPath = ReadString(file, fileSize);
+
+		// If it's a star, point light info
+		if (object.Type == ObjectType::Sun)
+		{
+			file.read((char*)&object.Light.Color,	  sizeof(glm::vec3));
+			file.read((char*)&object.Light.Intensity, sizeof(float));
+		}
+	}
+
+	if (!file.good())
+	{
+		LOG_ERROR("Scene file {} ends too early.", std::filesystem::absolute(readPath).string());
+
+		return {};
+	}
+
+	return scene;
+}
+
+bool SceneFile::Write(const std::string& path) const
+{
+	ChunkWriter writer;
+
+	// Scene info and camera
+	writer.Begin(ChunkId::Info);
+	writer.Append(&Camera, sizeof(CameraRecord));
+	writer.Append(Name.data(), Name.size());
+	writer.End();
+
+	writer.Begin(ChunkId::Types);
+	writer.AppendField<uint8_t>(Objects, [](const ObjectRecord& object) { return (uint8_t)object.Type; });
+	writer.End();
+
+	std::vector<const std::string*> tags;
+
+	for (const ObjectRecord& object : Objects)
+	{
+		tags.push_back(&object.Tag);
+	}
+
+	writer.Begin(ChunkId::Tags);
+	writer.AppendStrings(tags);
+	writer.End();
+
+	// Transform
+	writer.Begin(ChunkId::Positions);
+	writer.AppendField<glm::vec3>(Objects, [](const ObjectRecord& object) { return object.ObjectTransform.Position; });
+	writer.End();
+
+	writer.Begin(ChunkId::Rotations);
+	writer.AppendField<glm::vec3>(Objects, [](const ObjectRecord& object) { return object.ObjectTransform.Rotation; });
+	writer.End();
+
+	writer.Begin(ChunkId::Scales);
+	writer.AppendField<glm::vec3>(Objects, [](const ObjectRecord& object) { return object.ObjectTransform.Scale; });
+	writer.End();
+
+	// Physics
+	writer.Begin(ChunkId::LinearVelocities);
+	writer.AppendField<glm::vec3>(Objects, [](const ObjectRecord& object) { return object.ObjectPhysics.LinearVelocity; });
+	writer.End();
+
+	writer.Begin(ChunkId::AngularVelocities);
+	writer.AppendField<glm::vec3>(Objects, [](const ObjectRecord& object) { return object.ObjectPhysics.AngularVelocity; });
+	writer.End();
+
+	writer.Begin(ChunkId::Masses);
+	writer.AppendField<float>(Objects, [](const ObjectRecord& object) { return object.ObjectPhysics.Mass; });
+	writer.End();
+
+	// Material
+	writer.Begin(ChunkId::Colors);
+	writer.AppendField<glm::vec4>(Objects, [](const ObjectRecord& object) { return object.Color; });
+	writer.End();
+
+	writer.Begin(ChunkId::Shininess);
+	writer.AppendField<float>(Objects, [](const ObjectRecord& object) { return object.Shininess; });
+	writer.End();
+
+	writer.Begin(ChunkId::Roughness);
+	writer.AppendField<float>(Objects, [](const ObjectRecord& object) { return object.Roughness; });
+	writer.End();
+
+	// Textures, most objects share the same few, so every path is stored once
+	std::unordered_map<std::string, uint32_t> pathIds;
+	std::vector<const std::string*> paths;
+	std::vector<uint32_t> textureIds;
+
+	for (const ObjectRecord& object : Objects)
+	{
+		for (const std::string* path : { &object.AlbedoPath, &object.NormalPath, &object.SpecularPath })
+		{
+			auto [it, added] = pathIds.try_emplace(*path, (uint32_t)paths.size());
+
+			if (added)
+			{
+				paths.push_back(path);
+			}
+
+			textureIds.push_back(it->second);
+		}
+	}
+
+	writer.Begin(ChunkId::TexturePaths);
+	writer.AppendStrings(paths);
+	writer.End();
+
+	writer.Begin(ChunkId::TextureIds);
+	writer.Append(textureIds.data(), textureIds.size() * sizeof(uint32_t));
+	writer.End();
+
+	// Point lights, kept for every object so the array lines up with the others, only suns use theirs
+	writer.Begin(ChunkId::Lights);
+	writer.AppendField<PointLight>(Objects, [](const ObjectRecord& object) { return object.Light; });
+	writer.End();
+
+	const std::vector<uint8_t>& data = writer.Finish(Objects.size());
+
+	return FileUtils::WriteAtomically(path, data.data(), data.size());
+}
+
+uint64_t SceneFile::Hash() const
+{
+	uint64_t hash = 0xCBF29CE484222325ull;
+
+	auto mix = [&hash](const void* data, size_t size)
+		{
+			const uint8_t* bytes = (const uint8_t*)data;
+
+			for (size_t i = 0; i < size; i++)
+			{
+				hash = (hash ^ bytes[i]) * 0x100000001B3ull;
+			}
+		};
+
+	// Lengths go in too, moving a character from one string to the next must change the hash
+	auto mixString = [&mix](const std::string& str)
+		{
+			size_t size = str.size();
+			mix(&size, sizeof(size_t));
+			mix(str.data(), size);
+		};
+
+	mixString(Name);
+	mix(&Camera, sizeof(CameraRecord));
+
+	for (const ObjectRecord& object : Objects)
+	{
+		mixString(object.Tag);
+		mix(&object.Type, sizeof(ObjectType));
+		mix(&object.ObjectTransform.Position, sizeof(glm::vec3));
+		mix(&object.ObjectTransform.Rotation, sizeof(glm::vec3));
+		mix(&object.ObjectTransform.Scale, sizeof(glm::vec3));
+		mix(&object.ObjectPhysics.LinearVelocity, sizeof(glm::vec3));
+		mix(&object.ObjectPhysics.AngularVelocity, sizeof(glm::vec3));
+		mix(&object.ObjectPhysics.Mass, sizeof(float));
+		mix(&object.Color, sizeof(glm::vec4));
+		mix(&object.Shininess, sizeof(float));
+		mix(&object.Roughness, sizeof(float));
+		mixString(object.AlbedoPath);
+		mixString(object.NormalPath);
+		mixString(object.SpecularPath);
+		mix(&object.Light.Color, sizeof(glm::vec3));
+		mix(&object.Light.Intensity, sizeof(float));
+	}
+
+	return hash;
+}
\ No newline at end of file
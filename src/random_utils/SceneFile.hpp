@@ -0,0 +1,71 @@
+#pragma once
+
+#include "../objects/SceneObject.hpp"
+#include "../physics/BodyStore.hpp"
+
+#include <glm/glm.hpp>
+
+#include <string>
+#include <optional>
+#include <vector>
+
+// Plain contents of an .sscene file, nothing loaded onto the GPU and no scene built out of it.
+// Reading and writing one needs neither a window nor a GL context, so headless runs use it directly.
+//
+// Files are written chunked: a header, a table with the id, offset and size of every chunk, then the chunks.
+// Per object fields are stored as one array each, so a whole chunk is a single copy out of the mapped file.
+// Readers skip chunks they don't know, newer writers can add some without breaking older builds.
+// Files in the old SSSSCENE format, one object after another, still get read.
+struct SceneFile
+{
+	struct CameraRecord
+	{
+		float AspectRatio = 16.0f / 9.0f;
+		float NearClip = 0.1f;
+		float FarClip = 1000.0f;
+		float FOV = 45.0f;
+		float Pitch = 0.0f;
+		float Yaw = 0.0f;
+		glm::vec3 Position = { 0.0f, 0.0f, 0.0f };
+	};
+
+	struct ObjectRecord
+	{
+		std::string Tag;
+		ObjectType Type = ObjectType::Planet;
+
+		Transform ObjectTransform;
+		Physics ObjectPhysics;
+
+		glm::vec4 Color = { 0.44f, 0.44f, 0.44f, 1.0f };
+		float Shininess = 1.0f;
+		float Roughness = 0.0f;
+
+		std::string AlbedoPath;
+		std::string NormalPath;
+		std::string SpecularPath;
+
+		// Only stored for suns
+		PointLight Light;
+	};
+
+	std::string Name;
+	CameraRecord Camera;
+	std::vector<ObjectRecord> Objects;
+
+	// With outBodies given the dynamic state gets copied into it too, straight from the file's arrays
+	static std::optional<SceneFile> Read(const std::string& path, BodyStore* outBodies = nullptr);
+
+	// Always in the chunked format, old files get converted by reading and writing them again.
+	// A crash mid-write leaves the previous file intact.
+	bool Write(const std::string& path) const;
+
+	// FNV-1a over everything Write stores, equal hashes mean there is nothing new to write
+	uint64_t Hash() const;
+
+	inline static constexpr uint32_t VERSION = 1;
+
+private:
+	static std::optional<SceneFile> ReadLegacy(const std::string& path);
+	static std::optional<SceneFile> ReadChunked(const uint8_t* data, size_t size, BodyStore* outBodies);
+};
\ No newline at end of file
@@ -3,149 +3,108 @@
 #include "../Timer.hpp"
 #include "../TextureManager.hpp"
 #include "../scenes/EditorScene.hpp"
+#include "SceneFile.hpp"
 
 #include <filesystem>
-#include <fstream>
-
-#define READ_AND_ASSERT_EOF(file, dest, type) if(file.eof()) { return {}; } file.read((char*)&dest, sizeof(type))
+#include <unordered_set>
 
 std::optional<EditorScene> SceneSerializer::LoadScene(const std::string& path)
 {
 	FUNC_PROFILE();
 
-	std::filesystem::path readPath = std::filesystem::path(path);
-	if (!std::filesystem::exists(readPath))
-	{
-		LOG_ERROR("Path {} does not exist.", readPath.string());
-
-		return {};
-	}
-
-	std::fstream file(readPath, std::ios::in | std::ios::binary);
-	if (!file.good())
-	{
-		LOG_ERROR("File {} could not be opened.", std::filesystem::absolute(readPath).string());
-
-		file.close();
-		return {};
-	}
-
-	char buf[512]{};
-	file.read(buf, 9);
-
-	if (strcmp(buf, "SSSSCENE") != 0)
+	std::optional<SceneFile> sceneFile = SceneFile::Read(path);
+	if (!sceneFile.has_value())
 	{
-		LOG_ERROR("Wrong scene file header.");
-
-		file.close();
 		return {};
 	}
 
 	EditorScene scene;
 
 	// Scene info
-	int32_t sceneNameLen{};
-	file.read((char*)&sceneNameLen, sizeof(int32_t));
-	file.read(buf, sceneNameLen);
-	scene.m_SceneName = buf;
+	scene.m_SceneName = sceneFile->Name;
 
 	// Camera
-	file.read((char*)&scene.m_Camera.m_AspectRatio, sizeof(float));
-	file.read((char*)&scene.m_Camera.m_NearClip,	sizeof(float));
-	file.read((char*)&scene.m_Camera.m_FarClip,		sizeof(float));
-	file.read((char*)&scene.m_Camera.m_FOV,			sizeof(float));
-	file.read((char*)&scene.m_Camera.m_Pitch,		sizeof(float));
-	file.read((char*)&scene.m_Camera.m_Yaw,			sizeof(float));
-	file.read((char*)&scene.m_Camera.m_Position,	sizeof(glm::vec3));
+	const SceneFile::CameraRecord& camera = sceneFile->Camera;
+	scene.m_Camera.m_AspectRatio = camera.AspectRatio;
+	scene.m_Camera.m_NearClip	 = camera.NearClip;
+	scene.m_Camera.m_FarClip	 = camera.FarClip;
+	scene.m_Camera.m_FOV		 = camera.FOV;
+	scene.m_Camera.m_Pitch		 = camera.Pitch;
+	scene.m_Camera.m_Yaw		 = camera.Yaw;
+	scene.m_Camera.m_Position	 = camera.Position;
 	scene.m_Camera.UpdateProjection();
 	scene.m_Camera.UpdateView();
 
 	TextureManager::ReInit();
-	
-	// Objects
-	int32_t objectsCount{};
-	file.read((char*)&objectsCount, sizeof(int32_t));
 
-	for (int32_t i = 0; i < objectsCount; i++)
+	// Every texture the scene uses gets decoded up front in parallel, the lookups below only find them
+	std::vector<std::string> texturePaths;
+	std::unordered_set<std::string> seen;
+
+	for (const SceneFile::ObjectRecord& object : sceneFile->Objects)
+	{
+		for (const std::string* path : { &object.AlbedoPath, &object.NormalPath, &object.SpecularPath })
+		{
+			bool isDefault = *path == "Default Albedo" || *path == "Default Normal" || *path == "Default Specular";
+
+			if (!isDefault && seen.insert(*path).second)
+			{
+				texturePaths.push_back(*path);
+			}
+		}
+	}
+
+	TextureManager::AddTextures(texturePaths);
+
+	// Objects
+	for (const SceneFile::ObjectRecord& object : sceneFile->Objects)
 	{
-		// Object info
-		int32_t tagLen{};
-		ObjectType type{};
-		file.read((char*)&tagLen, sizeof(int32_t));
-		file.read(buf, tagLen);
-		file.read((char*)&type, sizeof(ObjectType));
-
-		std::unique_ptr<Planet> planet = type == ObjectType::Planet ? std::make_unique<Planet>() : std::make_unique<Sun>();
-		planet->m_Tag = buf;
-
-		// Transform
-		file.read((char*)&planet->m_Transform.Position, sizeof(glm::vec3));
-		file.read((char*)&planet->m_Transform.Rotation, sizeof(glm::vec3));
-		file.read((char*)&planet->m_Transform.Scale,	sizeof(glm::vec3));
-
-		// Physics
-		file.read((char*)&planet->m_Physics.LinearVelocity,	 sizeof(glm::vec3));
-		file.read((char*)&planet->m_Physics.AngularVelocity, sizeof(glm::vec3));
-		file.read((char*)&planet->m_Physics.Mass,			 sizeof(float));
+		std::unique_ptr<Planet> planet = object.Type == ObjectType::Planet ? std::make_unique<Planet>() : std::make_unique<Sun>();
+		planet->m_Tag = object.Tag;
+
+		planet->m_Transform = object.ObjectTransform;
+		planet->m_Physics	= object.ObjectPhysics;
 
 		// Material
-		file.read((char*)&planet->m_Material.Color,		sizeof(glm::vec4));
-		file.read((char*)&planet->m_Material.Shininess, sizeof(float));
-		file.read((char*)&planet->m_Material.Roughness, sizeof(float));
+		planet->m_Material.Color	 = object.Color;
+		planet->m_Material.Shininess = object.Shininess;
+		planet->m_Material.Roughness = object.Roughness;
 
 		// Textures
-		int32_t albedoPathLen{};
-		file.read((char*)&albedoPathLen, sizeof(int32_t));
-		file.read(buf, albedoPathLen);
-		std::string albedoPath = buf;
-
-		int32_t normalPathLen{};
-		file.read((char*)&normalPathLen, sizeof(int32_t));
-		file.read(buf, normalPathLen);
-		std::string normalPath = buf;
-
-		int32_t specularPathLen{};
-		file.read((char*)&specularPathLen, sizeof(int32_t));
-		file.read(buf, specularPathLen);
-		std::string specularPath = buf;
-
-		if (albedoPath == "Default Albedo")
+		if (object.AlbedoPath == "Default Albedo")
 		{
 			planet->m_Material.TextureID = TextureManager::GetTexture(TextureManager::DEFAULT_ALBEDO).value().TextureID;
 		}
 		else
 		{
-			planet->m_Material.TextureID = TextureManager::AddTexture(albedoPath)
+			planet->m_Material.TextureID = TextureManager::AddTexture(object.AlbedoPath)
 				.value_or(TextureManager::GetTexture(TextureManager::DEFAULT_ALBEDO).value()).TextureID;
 		}
 
-		if (normalPath == "Default Normal")
+		if (object.NormalPath == "Default Normal")
 		{
 			planet->m_Material.NormalMapTextureID = TextureManager::GetTexture(TextureManager::DEFAULT_NORMAL).value().TextureID;
 		}
 		else
 		{
-			planet->m_Material.NormalMapTextureID = TextureManager::AddTexture(normalPath)
+			planet->m_Material.NormalMapTextureID = TextureManager::AddTexture(object.NormalPath)
 				.value_or(TextureManager::GetTexture(TextureManager::DEFAULT_NORMAL).value()).TextureID;
 		}
 
-		if (specularPath == "Default Specular")
+		if (object.SpecularPath == "Default Specular")
 		{
 			planet->m_Material.SpecularMapTextureID = TextureManager::GetTexture(TextureManager::DEFAULT_SPECULAR).value().TextureID;
 		}
 		else
 		{
-			planet->m_Material.SpecularMapTextureID = TextureManager::AddTexture(specularPath)
+			planet->m_Material.SpecularMapTextureID = TextureManager::AddTexture(object.SpecularPath)
 				.value_or(TextureManager::GetTexture(TextureManager::DEFAULT_SPECULAR).value()).TextureID;
 		}
 		
 		// If it's a star, point light info
 		if (planet->m_Type == ObjectType::Sun)
 		{
-			Sun* sun = (Sun*)planet.get();
-		
-			file.read((char*)&sun->m_Light.Color,	  sizeof(glm::vec3));
-			file.read((char*)&sun->m_Light.Intensity, sizeof(float));
+			((Sun*)planet.get())->m_Light = object.Light;
 		}
 
 		scene.m_Planets.push_back(std::move(planet));
@@ -160,104 +119,78 @@ bool SceneSerializer::SaveScene(const EditorScene& scene)
 {
 	FUNC_PROFILE();
 
-	std::fstream file;
-	std::filesystem::path writePath = std::filesystem::current_path().append("Scenes");
-
-	if (!std::filesystem::exists(writePath))
-	{
-		std::filesystem::create_directory(writePath);
-	}
+	std::string writePath = GetSavePath(scene.m_SceneName);
 
-	writePath.append(scene.m_SceneName + ".sscene");
-
-	file.open(writePath, std::ios::out | std::ios::binary);
-	if (!file.good())
+	if (!CaptureScene(scene).Write(writePath))
 	{
-		LOG_ERROR("Saving scene {} failed: file {} could not be created/opened.", scene.m_SceneName, std::filesystem::absolute(writePath).string());
+		LOG_ERROR("Saving scene {} failed: file {} could not be written.", scene.m_SceneName, std::filesystem::absolute(writePath).string());
 
-		file.close();
 		return false;
 	}
 
-	// Header
-	file.write("SSSSCENE", 9);
+	LOG_INFO("Saved scene {} to: {}", scene.m_SceneName, std::filesystem::absolute(writePath).string());
+
+	return true;
+}
+
+SceneFile SceneSerializer::CaptureScene(const EditorScene& scene)
+{
+	SceneFile sceneFile;
 
 	// Scene info
-	int32_t sceneNameLen = scene.m_SceneName.length() + 1;
-	file.write((char*)&sceneNameLen, sizeof(int32_t));
-	file.write(scene.m_SceneName.c_str(), sceneNameLen);
+	sceneFile.Name = scene.m_SceneName;
 
 	// Camera
-	file.write((char*)&scene.m_Camera.m_AspectRatio, sizeof(float));
-	file.write((char*)&scene.m_Camera.m_NearClip,	 sizeof(float));
-	file.write((char*)&scene.m_Camera.m_FarClip,	 sizeof(float));
-	file.write((char*)&scene.m_Camera.m_FOV,		 sizeof(float));
-	file.write((char*)&scene.m_Camera.m_Pitch,		 sizeof(float));
-	file.write((char*)&scene.m_Camera.m_Yaw,		 sizeof(float));
-	file.write((char*)&scene.m_Camera.m_Position,	 sizeof(glm::vec3));
+	sceneFile.Camera.AspectRatio = scene.m_Camera.m_AspectRatio;
+	sceneFile.Camera.NearClip	 = scene.m_Camera.m_NearClip;
+	sceneFile.Camera.FarClip	 = scene.m_Camera.m_FarClip;
+	sceneFile.Camera.FOV		 = scene.m_Camera.m_FOV;
+	sceneFile.Camera.Pitch		 = scene.m_Camera.m_Pitch;
+	sceneFile.Camera.Yaw		 = scene.m_Camera.m_Yaw;
+	sceneFile.Camera.Position	 = scene.m_Camera.m_Position;
 	
 	// Objects
-	int32_t objectsCount = scene.m_Planets.size();
-	file.write((char*)&objectsCount, sizeof(int32_t));
-
 	for (auto& planet : scene.m_Planets)
 	{
-		Transform& transform = planet->m_Transform;
-		Physics& physics	 = planet->m_Physics;
-		Material& material   = planet->m_Material;
-
-		// Object info
-		int32_t tagLen = planet->m_Tag.length() + 1;
-		file.write((char*)&tagLen, sizeof(int32_t));
-		file.write(planet->m_Tag.c_str(), tagLen);
-		file.write((char*)&planet->m_Type, sizeof(ObjectType));
-
-		// Transform
-		file.write((char*)&transform.Position, sizeof(glm::vec3));
-		file.write((char*)&transform.Rotation, sizeof(glm::vec3));
-		file.write((char*)&transform.Scale,	   sizeof(glm::vec3));
-
-		// Physics
-		file.write((char*)&physics.LinearVelocity,	sizeof(glm::vec3));
-		file.write((char*)&physics.AngularVelocity, sizeof(glm::vec3));
-		file.write((char*)&physics.Mass,			sizeof(float));
+		Material& material = planet->m_Material;
+		SceneFile::ObjectRecord& object = sceneFile.Objects.emplace_back();
+
+		object.Tag = planet->m_Tag;
+		object.Type = planet->m_Type;
+		object.ObjectTransform = planet->m_Transform;
+		object.ObjectPhysics = planet->m_Physics;
 
 		// Material
-		file.write((char*)&material.Color,	   sizeof(glm::vec4));
-		file.write((char*)&material.Shininess, sizeof(float));
-		file.write((char*)&material.Roughness, sizeof(float));
+		object.Color	 = material.Color;
+		object.Shininess = material.Shininess;
+		object.Roughness = material.Roughness;
 		
 		// Textures
-		std::string albedoPath = TextureManager::GetTexture(material.TextureID)
+		object.AlbedoPath = TextureManager::GetTexture(material.TextureID)
 			.value_or(TextureManager::GetTexture(TextureManager::DEFAULT_ALBEDO).value()).Path;
-		int32_t albedoPathLen = albedoPath.length() + 1;
-		file.write((char*)&albedoPathLen, sizeof(int32_t));
-		file.write(albedoPath.c_str(), albedoPathLen);
-
-		std::string normalPath = TextureManager::GetTexture(material.NormalMapTextureID)
+		object.NormalPath = TextureManager::GetTexture(material.NormalMapTextureID)
 			.value_or(TextureManager::GetTexture(TextureManager::DEFAULT_NORMAL).value()).Path;
-		int32_t normalPathLen = normalPath.length() + 1;
-		file.write((char*)&normalPathLen, sizeof(int32_t));
-		file.write(normalPath.c_str(), normalPathLen);
-
-		std::string specularPath = TextureManager::GetTexture(material.SpecularMapTextureID)
+		object.SpecularPath = TextureManager::GetTexture(material.SpecularMapTextureID)
 			.value_or(TextureManager::GetTexture(TextureManager::DEFAULT_SPECULAR).value()).Path;
-		int32_t specularPathLen = specularPath.length() + 1;
-		file.write((char*)&specularPathLen, sizeof(int32_t));
-		file.write(specularPath.c_str(), specularPathLen);
 
 		// If it's a star, point light info
 		if (planet->m_Type == ObjectType::Sun)
 		{
-			Sun* sun = (Sun*)planet.get();
-
-			file.write((char*)&sun->m_Light.Color,	   sizeof(glm::vec3));
-			file.write((char*)&sun->m_Light.Intensity, sizeof(float));
+			object.Light = ((Sun*)planet.get())->m_Light;
 		}
 	}
 
-	file.close();
-	LOG_INFO("Saved scene {} to: {}", scene.m_SceneName, std::filesystem::absolute(writePath).string());
-
-	return true;
+	return sceneFile;
 }
+
+std::string SceneSerializer::GetSavePath(const std::string& sceneName)
+{
+	std::filesystem::path writePath = std::filesystem::current_path().append("Scenes");
+
+	if (!std::filesystem::exists(writePath))
+	{
+		std::filesystem::create_directory(writePath);
+	}
+
+	return writePath.append(sceneName + ".sscene").string();
+}
\ No newline at end of file
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "SceneFile.hpp"
+
 #include <string>
 #include <optional>
 
@@ -11,6 +13,12 @@ public:
 	static std::optional<EditorScene> LoadScene(const std::string& path);
 	static bool SaveScene(const EditorScene& scene);
 
+	// Plain copy of everything a save writes, safe to hand over to another thread
+	static SceneFile CaptureScene(const EditorScene& scene);
+
+	// Where a scene of that name gets saved, the directory is created if needed
+	static std::string GetSavePath(const std::string& sceneName);
+
 private:
 	SceneSerializer() = default;
 };
\ No newline at end of file
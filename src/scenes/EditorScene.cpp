@@ -7,12 +7,16 @@
 #include "../Random.hpp"
 #include "states/EditorSceneStates.hpp"
 #include "../Simulator.hpp"
+#include "PlanetBodies.hpp"
 #include "../TextureManager.hpp"
 #include "../TriggerClock.hpp"
+#include "../JobSystem.hpp"
 
 #include <imgui/imgui.h>
 #include <glm/gtc/type_ptr.hpp>
 
+#include <algorithm>
+
 EditorScene::EditorScene()
 {
 	FUNC_PROFILE();
@@ -201,16 +205,26 @@ void EditorScene::OnUpdate(float ts)
 	{
 		m_ActiveState->OnUpdate(ts);
 	}
-}
 
-void EditorScene::OnTick()
-{
-	SimPhysics::ProgressAllOneStep(m_Planets);
+	if (!m_RenderOrbits)
+	{
+		m_PredictionCache.reset();
 
-	for (auto& planet : m_Planets)
+		return;
+	}
+
+	if (!m_PredictionCache)
 	{
-		planet->OnTick();
+		m_PredictionCache = std::make_unique<PredictionCache>();
 	}
+
+	m_PredictionCache->Sync(m_Planets, m_Time);
+	m_PredictionCache->Poll();
+}
+
+void EditorScene::OnTick()
+{
+	StepSimulation(SimClock::TPS_MULTIPLIER);
 }
 
 void EditorScene::OnRender()
@@ -240,21 +254,33 @@ void EditorScene::OnRender()
 
 	Renderer::SceneEnd();
 
+	// Same transforms feed all the passes below, build them once and in parallel
+	m_InstanceTransforms.resize(m_Planets.size());
+	JobSystem::ParallelFor(0, (uint32_t)m_Planets.size(), 64, [this](uint32_t chunkBegin, uint32_t chunkEnd)
+		{
+			for (uint32_t i = chunkBegin; i < chunkEnd; i++)
+			{
+				m_InstanceTransforms[i] = m_Planets[i]->GetTransform().Matrix();
+			}
+		});
+
 	// Draw spheres' outlines
 	Renderer::SceneBegin(m_Camera);
 	Renderer::BindSunShader();
 	Renderer::SetFrontCull();
 
-	for (auto& planet : m_Planets)
+	for (size_t i = 0; i < m_Planets.size(); i++)
 	{
+		Planet* planet = m_Planets[i].get();
+
 		if (glm::distance(planet->GetTransform().Position, m_Camera.GetPosition()) <= planet->GetMinRadius() * 1.06f)
 		{
 			continue;
 		}
 
-		glm::vec3 color = planet.get() == m_SelectedPlanet ? glm::vec3(0.98f, 0.24f, 0.0f) : glm::vec3(0.0f);
+		glm::vec3 color = planet == m_SelectedPlanet ? glm::vec3(0.98f, 0.24f, 0.0f) : glm::vec3(0.0f);
 
-		Renderer::SubmitSphereInstanced(planet->GetTransform().Matrix() * glm::scale(glm::mat4(1.0f), glm::vec3(1.05f)), 
+		Renderer::SubmitSphereInstanced(m_InstanceTransforms[i] * glm::scale(glm::mat4(1.0f), glm::vec3(1.05f)),
 			glm::vec4(color, planet->GetMaterial().Color.a));
 	}
 
@@ -264,18 +290,20 @@ void EditorScene::OnRender()
 
 	int32_t lightIdx = 0;
 
-	for (auto& planet : m_Planets)
+	for (size_t i = 0; i < m_Planets.size(); i++)
 	{
+		Planet* planet = m_Planets[i].get();
+
 		if (planet->GetType() != ObjectType::Sun)
 		{
 			continue;
 		}
 
 		Material lightMat = planet->GetMaterial();
-		PointLight light = ((Sun*)planet.get())->GetLight();
+		PointLight light = ((Sun*)planet)->GetLight();
 		lightMat.Color *= glm::vec4(light.Color * light.Intensity, 1.0f);
 
-		Renderer::SubmitSphereInstanced(planet->GetTransform().Matrix(), lightMat);
+		Renderer::SubmitSphereInstanced(m_InstanceTransforms[i], lightMat);
 		Renderer::SetPointLightUniform(lightIdx, light, planet->GetTransform().Position);
 		lightIdx++;
 	}
@@ -288,18 +316,23 @@ void EditorScene::OnRender()
 	Renderer::BindPlanetShader();
 	Renderer::SetBackCull();
 
-	for (auto& planet : m_Planets)
+	for (size_t i = 0; i < m_Planets.size(); i++)
 	{
-		if (planet->GetType() != ObjectType::Planet)
+		if (m_Planets[i]->GetType() != ObjectType::Planet)
 		{
 			continue;
 		}
 		
-		Renderer::SubmitSphereInstanced(planet->GetTransform().Matrix(), planet->GetMaterial());
+		Renderer::SubmitSphereInstanced(m_InstanceTransforms[i], m_Planets[i]->GetMaterial());
 	}
 
 	Renderer::SceneEnd();
 
+	if (m_RenderOrbits && m_PredictionCache)
+	{
+		DrawPredictedOrbits();
+	}
+
 	if (m_ActiveState)
 	{
 		m_ActiveState->OnRender();
@@ -322,6 +355,65 @@ uint32_t EditorScene::GetFramebufferTextureID() const
 	return m_FB->GetTextureID();
 }
 
+void EditorScene::StepSimulation(float timeScale)
+{
+	// Slider sets the global, the integrator takes it per step so the timeline can log it with the other settings
+	PlanetBodies::TakeSnapshot(m_Planets, m_Bodies);
+	m_System.GMultiplier = SimPhysics::G_CONSTANT_MULTIPLIER;
+	m_System.Step(m_Bodies, timeScale);
+	m_Time += (double)SimClock::TPS_STEP * timeScale;
+
+	if (!m_System.GetRemovedBodies().empty())
+	{
+		RemovePlanets(m_System.GetRemovedBodies());
+	}
+
+	for (size_t i = 0; i < m_Planets.size(); i++)
+	{
+		m_Planets[i]->GetTransform().Position = m_Bodies.Positions[i];
+		m_Planets[i]->GetPhysics().LinearVelocity = m_Bodies.Velocities[i];
+	}
+}
+
+void EditorScene::RemovePlanets(const std::vector<uint32_t>& indices)
+{
+	std::vector<std::unique_ptr<Planet>> remaining;
+	size_t next = 0;
+
+	remaining.reserve(m_Planets.size());
+
+	for (size_t i = 0; i < m_Planets.size(); i++)
+	{
+		if (next >= indices.size() || indices[next] != i)
+		{
+			remaining.push_back(std::move(m_Planets[i]));
+
+			continue;
+		}
+
+		if (m_SelectedPlanet == m_Planets[i].get())
+		{
+			m_SelectedPlanet = nullptr;
+			m_ActiveState.reset();
+		}
+
+		next++;
+	}
+
+	m_Planets = std::move(remaining);
+
+	// Only bodies pointing at a removed one are left with a dangling reference
+	for (std::unique_ptr<Planet>& planet : m_Planets)
+	{
+		Planet* reference = planet->GetRelativePlanet();
+
+		if (reference && std::none_of(m_Planets.begin(), m_Planets.end(), [reference](const std::unique_ptr<Planet>& other) { return other.get() == reference; }))
+		{
+			planet->SetRelativePlanet(nullptr);
+		}
+	}
+}
+
 void EditorScene::SetViewportOffset(const glm::vec2& offset)
 {
 	m_ViewportOffset = offset;
@@ -421,3 +513,31 @@ void EditorScene::DrawGridPlane()
 			{ distance + xOffset * 4.0f, 0.0f, z }, color);
 	}
 }
+
+void EditorScene::DrawPredictedOrbits()
+{
+	// Cache might still be catching up with a planet added or removed this frame
+	if (m_PredictionCache->GetBodyCount() != m_Planets.size())
+	{
+		return;
+	}
+
+	Renderer::SceneBegin(m_Camera);
+	Renderer::SetLineWidth(1.0f);
+
+	for (size_t i = 0; i < m_Planets.size(); i++)
+	{
+		// Relative paths get drawn around where their reference body is right now
+		const std::vector<glm::vec3>& path = m_PredictionCache->GetRelativePath(i);
+		int32_t referenceIdx = m_PredictionCache->GetReferenceBody(i);
+		glm::vec3 origin = referenceIdx < 0 ? glm::vec3(0.0f) : m_Planets[referenceIdx]->GetTransform().Position;
+		glm::vec4 color = glm::vec4(glm::vec3(m_Planets[i]->GetMaterial().Color), 1.0f);
+
+		for (size_t j = 1; j < path.size(); j++)
+		{
+			Renderer::DrawLine(path[j - 1] + origin, path[j] + origin, color);
+		}
+	}
+
+	Renderer::SceneEnd();
+}
\ No newline at end of file
@@ -3,6 +3,9 @@
 #include "../renderer/Camera.hpp"
 #include "../objects/Sun.hpp"
 #include "states/SceneState.hpp"
+#include "../PredictionCache.hpp"
+#include "../physics/BodyStore.hpp"
+#include "../physics/SystemIntegrator.hpp"
 
 #include <memory>
 
@@ -30,7 +33,10 @@ public:
 
 	inline std::vector<std::unique_ptr<Planet>>& GetPlanetsRef() { return m_Planets; }
 	inline Planet* SelectedPlanet() { return m_SelectedPlanet; }
+	inline bool IsSpreadEnabled() const { return m_RenderSpread; }
+	inline const std::string& GetName() const { return m_SceneName; }
 
+	void StepSimulation(float timeScale);
 	void SetViewportOffset(const glm::vec2& offset);
 	void CancelState();
 
@@ -38,6 +44,8 @@ private:
 	EditorScene& Assign(EditorScene&& other) noexcept;
 	void CheckForPlanetSelect();
 	void DrawGridPlane();
+	void DrawPredictedOrbits();
+	void RemovePlanets(const std::vector<uint32_t>& indices);
 
 	std::string m_SceneName = "New scene";
 	std::string m_ScenePath = "";
@@ -45,6 +53,10 @@ private:
 	std::unique_ptr<SceneState> m_ActiveState;
 
 	std::vector<std::unique_ptr<Planet>> m_Planets;
+	std::vector<glm::mat4> m_InstanceTransforms;
+	std::unique_ptr<PredictionCache> m_PredictionCache;
+	BodyStore m_Bodies;
+	SystemIntegrator m_System;
 	Planet* m_SelectedPlanet = nullptr;
 
 	Camera m_Camera;
@@ -54,9 +66,14 @@ private:
 	std::shared_ptr<Cubemap> m_SkyboxTex;
 	glm::vec2 m_ViewportOffset;
 
+	// Simulated days since the scene was loaded, the editor itself never steps it
+	double m_Time = 0.0;
+
 	float m_TS = 0.0f;
 	bool  m_RenderGrid = true;
 	bool  m_RenderSkybox = false;
+	bool  m_RenderOrbits = false;
+	bool  m_RenderSpread = false;
 	bool  m_LockFocusOnPlanet = false;
 	
 	static inline float TS_MULTIPLIER = 1.0f;
@@ -0,0 +1,35 @@
+#include "PlanetBodies.hpp"
+#include "../Simulator.hpp"
+#include "../physics/SimClock.hpp"
+
+void PlanetBodies::ProgressAllOneStep(std::vector<std::unique_ptr<Planet>>& planets)
+{
+	ProgressAllOneStep(planets, SimClock::TPS_MULTIPLIER);
+}
+
+void PlanetBodies::ProgressAllOneStep(std::vector<std::unique_ptr<Planet>>& planets, float timeScale)
+{
+	static thread_local BodyStore s_Bodies;
+
+	TakeSnapshot(planets, s_Bodies);
+	SimPhysics::AccelerateAll(s_Bodies, timeScale);
+
+	for (size_t i = 0; i < planets.size(); i++)
+	{
+		planets[i]->GetPhysics().LinearVelocity = s_Bodies.Velocities[i];
+	}
+}
+
+void PlanetBodies::TakeSnapshot(const std::vector<std::unique_ptr<Planet>>& planets, BodyStore& outBodies)
+{
+	outBodies.Resize(planets.size());
+
+	for (size_t i = 0; i < planets.size(); i++)
+	{
+		Planet& planet = *planets[i];
+
+		outBodies.Positions[i]	= planet.GetTransform().Position;
+		outBodies.Velocities[i] = planet.GetPhysics().LinearVelocity;
+		outBodies.Masses[i]		= planet.GetPhysics().Mass;
+	}
+}
\ No newline at end of file
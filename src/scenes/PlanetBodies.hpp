@@ -0,0 +1,20 @@
+#pragma once
+
+#include "../objects/Planet.hpp"
+#include "../physics/BodyStore.hpp"
+
+#include <memory>
+#include <vector>
+
+// Bridge between the editor's planets and the physics core, which only ever sees BodyStore
+class PlanetBodies
+{
+public:
+	static void ProgressAllOneStep(std::vector<std::unique_ptr<Planet>>& planets);
+	static void ProgressAllOneStep(std::vector<std::unique_ptr<Planet>>& planets, float timeScale);
+
+	static void TakeSnapshot(const std::vector<std::unique_ptr<Planet>>& planets, BodyStore& outBodies);
+
+private:
+	PlanetBodies() = default;
+};
\ No newline at end of file
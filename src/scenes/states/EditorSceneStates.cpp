@@ -6,6 +6,7 @@
 #include "../../Application.hpp"
 #include "../../Logger.hpp"
 #include "../Simulator.hpp"
+#include "../../physics/EnsembleIntegrator.hpp"
 
 #include <glm/gtx/compatibility.hpp>
 
@@ -60,30 +61,44 @@ void SettingVelocityState::OnEvent(Event& ev)
 
 		return;
 	}
-
-	if (ev.Type == Event::MouseMoved && !m_PathFuture.valid())
-	{
-		m_PathFuture = std::async(std::launch::async, 
-			m_TargetPlanet->GetRelativePlanet() == nullptr ? SimPhysics::ApproximateNextNPoints : SimPhysics::ApproximateRelativeNextNPoints,
-			std::ref(m_ParentScene->GetPlanetsRef()), m_TargetPlanet, 1024);
-	}
 }
 
 void SettingVelocityState::OnUpdate(float ts)
 {
-	using namespace std::chrono_literals;
-
-	if (m_PathFuture.valid() && m_PathFuture.wait_for(0ms) == std::future_status::ready)
-	{
-		m_ApproximatedPath = m_PathFuture.get();
-	}
+	m_Predictor.Poll(m_ApproximatedPath);
+	m_Predictor.PollSpread(m_SpreadPaths);
 
 	glm::vec3 planetScreenPos = Renderer::WorldToScreenCoords(m_TargetPlanet->GetTransform().Position);
 	glm::vec2 mouseScreenPos = Input::GetMousePosition() - m_Offset;
 	glm::vec3 mouseWorldPos = Renderer::ScreenToWorldCoords(mouseScreenPos, planetScreenPos.z);
+	glm::vec3 newVelocity = m_TargetPlanet->GetTransform().Position - mouseWorldPos;
+
+	bool wantsSpread = m_ParentScene->IsSpreadEnabled();
+	bool wantsLongHorizon = Input::IsKeyPressed(Key::LeftShift);
 
-	m_Velocity = m_TargetPlanet->GetTransform().Position - mouseWorldPos;
+	if (newVelocity == m_Velocity && m_PathRequested && wantsSpread == m_SpreadRequested && wantsLongHorizon == m_LongHorizonRequested)
+	{
+		return;
+	}
+
+	PredictionOptions options;
+	options.EnsembleMembers = wantsSpread ? EnsembleIntegrator::DEFAULT_MEMBERS : 0;
+	options.SpreadAngle = glm::radians(2.0f);
+	options.Parareal = wantsLongHorizon;
+
+	// Predictor starts over on the newest velocity, whatever it was still computing gets dropped.
+	// Holding shift looks LONG_HORIZON_MULTIPLIER times further ahead, spread across all cores in time slices.
+	m_Velocity = newVelocity;
 	m_TargetPlanet->GetPhysics().LinearVelocity = m_Velocity;
+	m_Predictor.Request(m_ParentScene->GetPlanetsRef(), m_TargetPlanet, wantsLongHorizon ? 1024 * LONG_HORIZON_MULTIPLIER : 1024, options);
+	m_PathRequested = true;
+	m_SpreadRequested = wantsSpread;
+	m_LongHorizonRequested = wantsLongHorizon;
+
+	if (!wantsSpread)
+	{
+		m_SpreadPaths.clear();
+	}
 }
 
 void SettingVelocityState::OnRender()
@@ -100,6 +115,16 @@ void SettingVelocityState::OnRender()
 
 	glm::vec3 relativePos = m_TargetPlanet->GetRelativePlanet() ?
 		m_TargetPlanet->GetRelativePlanet()->GetTransform().Position : glm::vec3(0.0f, 0.0f, 0.0f);
+
+	// Spread goes first so the main path stays on top of it
+	for (const std::vector<glm::vec3>& path : m_SpreadPaths)
+	{
+		for (size_t i = 1; i < path.size(); i++)
+		{
+			Renderer::DrawLine(path[i - 1] + relativePos, path[i] + relativePos, { 0.0f, 1.0f, 0.0f, 0.3f });
+		}
+	}
+
 	for (size_t i = 1; i < m_ApproximatedPath.size(); i++)
 	{
 		Renderer::DrawLine(m_ApproximatedPath[i - 1] + relativePos, m_ApproximatedPath[i] + relativePos, { 0.0f, 1.0f, 0.0f, 1.0f });
@@ -4,9 +4,9 @@
 #include <glm/gtx/quaternion.hpp>
 
 #include "SceneState.hpp"
+#include "../../TrajectoryPredictor.hpp"
 
 #include <vector>
-#include <future>
 
 class EditorScene;
 class Planet;
@@ -41,7 +41,13 @@ private:
 	glm::vec3 m_Velocity = { 0.0f, 0.0f, 0.0f };
 	glm::vec2 m_Offset   = { 0.0f, 0.0f };
 	std::vector<glm::vec3> m_ApproximatedPath;
-	std::future<std::vector<glm::vec3>> m_PathFuture;
+	std::vector<std::vector<glm::vec3>> m_SpreadPaths;
+	TrajectoryPredictor m_Predictor;
+	bool m_PathRequested = false;
+	bool m_SpreadRequested = false;
+	bool m_LongHorizonRequested = false;
+
+	inline static constexpr uint32_t LONG_HORIZON_MULTIPLIER = 10;
 
 	Planet* m_TargetPlanet = nullptr;
 
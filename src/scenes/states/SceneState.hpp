@@ -6,6 +6,8 @@ class Camera;
 class SceneState
 {
 public:
+	virtual ~SceneState() = default;
+
 	virtual void OnEvent(Event& ev) = 0;
 	virtual void OnUpdate(float ts) = 0;
 	virtual void OnRender()			= 0;
@@ -1,8 +1,12 @@
 #include <gtest/gtest.h>
 #include <filesystem>
+#include <fstream>
 
-#include "../src/Simulator.hpp"
+#include "../src/scenes/PlanetBodies.hpp"
 #include "../src/random_utils/SceneSerializer.hpp"
+#include "../src/random_utils/SceneFile.hpp"
+#include "../src/random_utils/FileUtils.hpp"
+#include "../src/Logger.hpp"
 #include "../src/scenes/EditorScene.hpp"
 #include "../src/Application.hpp"
 #include "../src/renderer/IcosahedronSphere.hpp"
@@ -18,7 +22,7 @@ TEST(Simulation, SinglePlanet)
 	planet.GetPhysics().Mass = 1.0f;
 	planet.GetPhysics().LinearVelocity = { 0.0f, 0.0f, 0.0f };
 
-	SimPhysics::ProgressAllOneStep(planets);
+	PlanetBodies::ProgressAllOneStep(planets);
 
 	ASSERT_EQ(planet.GetPhysics().LinearVelocity, glm::vec3(0.0f)) << "Planet got force while its the only planet";
 }
@@ -37,7 +41,7 @@ TEST(Simulation, NegativeMass)
 	planet2.GetPhysics().Mass = 0.0f;
 	planet2.GetPhysics().LinearVelocity = { 0.0f, 0.0f, 0.0f };
 
-	SimPhysics::ProgressAllOneStep(planets);
+	PlanetBodies::ProgressAllOneStep(planets);
 
 	ASSERT_EQ(planet1.GetPhysics().LinearVelocity, glm::vec3(0.0f)) << "Negative mass was actually calcualted";
 	ASSERT_EQ(planet2.GetPhysics().LinearVelocity, glm::vec3(0.0f)) << "Negative mass was actually calcualted";
@@ -57,7 +61,7 @@ TEST(Simulation, ZeroMass)
 	planet2.GetPhysics().Mass = 0.0f;
 	planet2.GetPhysics().LinearVelocity = { 0.0f, 0.0f, 0.0f };
 
-	SimPhysics::ProgressAllOneStep(planets);
+	PlanetBodies::ProgressAllOneStep(planets);
 
 	ASSERT_EQ(planet1.GetPhysics().LinearVelocity, glm::vec3(0.0f)) << "Zero mass was actually calculated";
 	ASSERT_EQ(planet2.GetPhysics().LinearVelocity, glm::vec3(0.0f)) << "Zero mass was actually calculated";
@@ -79,7 +83,7 @@ TEST(Simulation, ZeroDistance)
 	planet2.GetPhysics().Mass = 0.0000015f;
 	planet2.GetPhysics().LinearVelocity = { 0.0f, 0.0f, 0.0f };
 
-	SimPhysics::ProgressAllOneStep(planets);
+	PlanetBodies::ProgressAllOneStep(planets);
 	
 	ASSERT_EQ(planet1.GetPhysics().LinearVelocity, glm::vec3(0.0f)) << "Force was calculated for object with a distance of 0 => div by 0";
 	ASSERT_EQ(planet2.GetPhysics().LinearVelocity, glm::vec3(0.0f)) << "Force was calculated for object with a distance of 0 => div by 0";
@@ -101,7 +105,7 @@ TEST(Simulation, ActuallyCalculating)
 	planet2.GetPhysics().Mass = 0.0000015f;
 	planet2.GetPhysics().LinearVelocity = { 0.0f, 0.0f, 0.0f };
 
-	SimPhysics::ProgressAllOneStep(planets);
+	PlanetBodies::ProgressAllOneStep(planets);
 
 	ASSERT_NE(planet1.GetPhysics().LinearVelocity, glm::vec3(0.0f)) << "No acceleration was added, event though it should have been";
 	ASSERT_NE(planet2.GetPhysics().LinearVelocity, glm::vec3(0.0f)) << "No acceleration was added, event though it should have been";
@@ -123,7 +127,7 @@ TEST(Simulation, EqualForceForSamePlanets)
 	planet2.GetPhysics().Mass = 1.0f;
 	planet2.GetPhysics().LinearVelocity = { 0.0f, 0.0f, 0.0f };
 
-	SimPhysics::ProgressAllOneStep(planets);
+	PlanetBodies::ProgressAllOneStep(planets);
 
 	ASSERT_EQ(planet1.GetPhysics().LinearVelocity, -planet2.GetPhysics().LinearVelocity) << "Forces were not exactly the opposite!";
 }
@@ -141,6 +145,131 @@ TEST(SceneSerializer, SavingScene)
 	std::filesystem::path writePath = std::filesystem::current_path().append("Scenes").append("New scene.sscene");
 	ASSERT_TRUE(std::filesystem::exists(writePath)) << "Scene " << writePath << " was not saved";
 }
+
+TEST(SceneSerializer, SceneFileRoundTripWithoutWindow)
+{
+	SceneFile written;
+	written.Name = "Headless";
+
+	SceneFile::ObjectRecord& sun = written.Objects.emplace_back();
+	sun.Tag = "Sun";
+	sun.Type = ObjectType::Sun;
+	sun.ObjectPhysics.Mass = 1.0f;
+	sun.Light.Intensity = 2.0f;
+
+	SceneFile::ObjectRecord& planet = written.Objects.emplace_back();
+	planet.Tag = "Planet";
+	planet.ObjectTransform.Position = { 10.0f, 0.0f, 0.0f };
+	planet.ObjectPhysics.LinearVelocity = { 0.0f, 0.0f, 1.0f };
+	planet.AlbedoPath = "Default Albedo";
+
+	std::filesystem::path path = std::filesystem::temp_directory_path().append("headless.sscene");
+	ASSERT_TRUE(written.Write(path.string()));
+
+	std::optional<SceneFile> read = SceneFile::Read(path.string());
+	ASSERT_TRUE(read.has_value()) << "Scene file written without a window couldn't be read back";
+	ASSERT_EQ(read->Name, written.Name);
+	ASSERT_EQ(read->Objects.size(), 2);
+	ASSERT_EQ(read->Objects[0].Light.Intensity, 2.0f);
+	ASSERT_EQ(read->Objects[1].ObjectTransform.Position, planet.ObjectTransform.Position);
+	ASSERT_EQ(read->Objects[1].ObjectPhysics.LinearVelocity, planet.ObjectPhysics.LinearVelocity);
+	ASSERT_EQ(read->Objects[1].AlbedoPath, planet.AlbedoPath);
+
+	BodyStore bodies;
+	ASSERT_TRUE(SceneFile::Read(path.string(), &bodies).has_value());
+	ASSERT_EQ(bodies.Size(), 2);
+	ASSERT_EQ(bodies.Positions[1], planet.ObjectTransform.Position);
+	ASSERT_EQ(bodies.Velocities[1], planet.ObjectPhysics.LinearVelocity);
+	ASSERT_EQ(bodies.Masses[0], sun.ObjectPhysics.Mass);
+
+	// Cut anywhere past the header, the chunk table points outside the file. Rejecting it logs.
+	Logger::Init();
+	std::filesystem::resize_file(path, std::filesystem::file_size(path) - 8);
+	ASSERT_FALSE(SceneFile::Read(path.string()).has_value());
+}
+
+TEST(SceneSerializer, LegacySceneFileImports)
+{
+	std::filesystem::path path = std::filesystem::temp_directory_path().append("legacy.sscene");
+	std::fstream file(path, std::ios::out | std::ios::binary);
+
+	auto writeString = [&file](const std::string& str)
+		{
+			int32_t length = (int32_t)str.length() + 1;
+			file.write((const char*)&length, sizeof(int32_t));
+			file.write(str.c_str(), length);
+		};
+
+	SceneFile::CameraRecord camera;
+	Transform transform;
+	transform.Position = { 3.0f, 0.0f, 0.0f };
+	Physics physics;
+	physics.Mass = 0.5f;
+	glm::vec4 color(1.0f);
+	float shininess = 2.0f;
+	float roughness = 0.5f;
+	PointLight light;
+	light.Intensity = 4.0f;
+	int32_t objectsCount = 1;
+	ObjectType type = ObjectType::Sun;
+
+	// One object after another, field by field, the way old builds saved scenes
+	file.write("SSSSCENE", 9);
+	writeString("Old");
+	file.write((const char*)&camera, sizeof(float) * 6 + sizeof(glm::vec3));
+	file.write((const char*)&objectsCount, sizeof(int32_t));
+	writeString("Star");
+	file.write((const char*)&type, sizeof(ObjectType));
+	file.write((const char*)&transform, sizeof(glm::vec3) * 3);
+	file.write((const char*)&physics, sizeof(glm::vec3) * 2 + sizeof(float));
+	file.write((const char*)&color, sizeof(glm::vec4));
+	file.write((const char*)&shininess, sizeof(float));
+	file.write((const char*)&roughness, sizeof(float));
+	writeString("Default Albedo");
+	writeString("Default Normal");
+	writeString("Default Specular");
+	file.write((const char*)&light.Color, sizeof(glm::vec3));
+	file.write((const char*)&light.Intensity, sizeof(float));
+	file.close();
+
+	BodyStore bodies;
+	std::optional<SceneFile> read = SceneFile::Read(path.string(), &bodies);
+	ASSERT_TRUE(read.has_value()) << "Old scene files have to keep loading";
+	ASSERT_EQ(read->Name, "Old");
+	ASSERT_EQ(read->Objects.size(), 1);
+	ASSERT_EQ(read->Objects[0].Tag, "Star");
+	ASSERT_EQ(read->Objects[0].Type, ObjectType::Sun);
+	ASSERT_EQ(read->Objects[0].Roughness, roughness);
+	ASSERT_EQ(read->Objects[0].SpecularPath, "Default Specular");
+	ASSERT_EQ(read->Objects[0].Light.Intensity, light.Intensity);
+	ASSERT_EQ(bodies.Positions[0], transform.Position);
+	ASSERT_EQ(bodies.Masses[0], physics.Mass);
+
+	// Saving it again converts it
+	ASSERT_TRUE(read->Write(path.string()));
+
+	std::optional<SceneFile> converted = SceneFile::Read(path.string());
+	ASSERT_TRUE(converted.has_value());
+	ASSERT_EQ(converted->Objects[0].Tag, "Star");
+	ASSERT_EQ(converted->Objects[0].NormalPath, "Default Normal");
+	ASSERT_EQ(converted->Objects[0].Light.Intensity, light.Intensity);
+}
+
+TEST(SceneSerializer, AtomicWriteReplacesWholeFile)
+{
+	std::filesystem::path path = std::filesystem::temp_directory_path().append("atomic.bin");
+	std::string first(4096, 'a');
+	std::string second = "short";
+
+	ASSERT_TRUE(FileUtils::WriteAtomically(path.string(), first.data(), first.size()));
+	ASSERT_TRUE(FileUtils::WriteAtomically(path.string(), second.data(), second.size()));
+
+	// Nothing of the longer previous contents survives and the temporary file is gone
+	std::ifstream file(path, std::ios::in | std::ios::binary);
+	std::string read((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+	ASSERT_EQ(read, second);
+	ASSERT_FALSE(std::filesystem::exists(path.string() + ".tmp"));
+}
 #pragma endregion
 
 #pragma region SphereGenerationTests